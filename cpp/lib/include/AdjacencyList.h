@@ -2,13 +2,14 @@
 
 #include "Graph.h"
 
+#include <cstddef>
 #include <cstdint>
 
 class AdjacencyList {
 
     /*
         General purpose Adjacency List
-        This uses a flat contiguous array with a constant stride based on the max degree within the graph
+        This uses a flat contiguous array with a constant stride of maxDegree + 1, so every row keeps at least one terminator
         Intended for large, sparse graphs
     */
 
@@ -18,10 +19,11 @@ class AdjacencyList {
 
         int nodeCount;
         int maxDegree;
+        int stride;
 
         // Constructors
 
-        AdjacencyList() : nodeCount(0), maxDegree(0), edges(nullptr) {}
+        AdjacencyList() : nodeCount(0), maxDegree(0), stride(0), edges(nullptr) {}
         AdjacencyList(Graph* g);
         AdjacencyList(int nodeCount, int maxDegree);
 
@@ -36,12 +38,15 @@ class AdjacencyList {
         void constructFrom(Graph* g);
 
         // Returns a pointer to list of edges connected to node. This list will have length at most this->maxDegree. 
-        // The value 255 serves as a terminator of the data (no more edges are connected), even if the index has not reached maxDegree-1
+        // The value 255 serves as a terminator of the data (no more edges are connected), and is always present, even for nodes of degree maxDegree
         uint8_t* getEdges(int node) const;
 
         // Adds the edge (u, v) to the internal array   
         void addEdge(uint8_t u, uint8_t v);
 
+        // Returns a 64-bit FNV-1a hash of the node count and every edge list, used to key on-disk caches to the graph
+        uint64_t getContentHash() const;
+
         // Returns the total memory footprint of the adjacency list in bytes
         size_t getMemoryFootprint() const;
 
@@ -6,16 +6,39 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdint>
+#include <algorithm>
+
+#include "ThreadPool.h"
 
 class Allocator {
 
+    public:
+
+        // How hard allocate() tries to back an arena with 2 MB pages (only arenas of at least one huge page qualify)
+        //   NONE        - plain 4 KB pages
+        //   TRANSPARENT - madvise(MADV_HUGEPAGE), the kernel promotes the arena when it can (default)
+        //   RESERVED    - MAP_HUGETLB from the reserved pool (vm.nr_hugepages), falling back to TRANSPARENT
+        enum class HugePages { NONE, TRANSPARENT, RESERVED };
+
+        // Which NUMA node the pages of a request end up on
+        //   FIRST_TOUCH - wherever the thread that first writes a page runs (the kernel default)
+        //   INTERLEAVE  - round robin over every node, page by page
+        //   PARTITIONED - split into nodeCount equal contiguous slices, slice n on node n. Matches a pool pinned with
+        //                 ThreadPool::constructFrom(.., true) working on ranges split evenly over its threads
+        // Placed requests start on a page boundary, so no page is shared with a neighbour of another policy
+        enum class Placement { FIRST_TOUCH, INTERLEAVE, PARTITIONED };
+
     private:
 
+        // Placed requests are aligned to a 4 KB page, the granularity of a memory policy
+        static constexpr size_t PLACEMENT_ALIGNMENT = 4096;
+
         struct AllocRequest {
             void** targetPtr;
             size_t sizeBytes;
             size_t alignment;
             std::string name;
+            Placement placement;
         };
 
         struct TrackedBlock {
@@ -24,13 +47,29 @@ class Allocator {
             bool isPending;
             bool isExternal; 
             int blockId; // Groups internally managed allocations by their parent arena
+            Placement placement;
         };
 
         std::vector<AllocRequest> pendingRequests;
         std::unordered_map<std::string, TrackedBlock> trackingMap;
         
-        // Keeps track of the massive heap blocks so we can free them later
-        std::vector<uint8_t*> memoryBlocks; 
+        // Where an arena came from, so the destructor hands it back the same way
+        enum class ArenaSource { HEAP, MAPPED, MAPPED_THP, MAPPED_HUGETLB, FILE };
+
+        struct Arena {
+            uint8_t* base;
+            size_t mappedBytes; // Size of the mapping (rounded up to the page size), or the heap block size
+            size_t usedBytes;   // Bytes the requests take up, padding included (the same whatever the arena is backed by)
+            ArenaSource source;
+            intptr_t fileHandle; // FILE arenas only: the backing file (a descriptor, or a HANDLE on Windows)
+            void* mappingHandle; // FILE arenas on Windows only: the file mapping object
+        };
+
+        // Keeps track of the massive blocks so we can free them later
+        std::vector<Arena> memoryBlocks; 
+        HugePages hugePages;
+        NumaTopology topology;
+        std::string backingDirectory;
 
         uint64_t totalAllocatedBytes;
         uint64_t totalPendingBytes;
@@ -46,23 +85,82 @@ class Allocator {
 
         // Template function safely extracts the size and alignment of the requested type
         template <typename T>
-        void requestAlloc(const std::string& name, size_t count, T** targetPtr) {
+        void requestAlloc(const std::string& name, size_t count, T** targetPtr, Placement placement = Placement::FIRST_TOUCH) {
             size_t sizeBytes = count * sizeof(T);
             size_t align = alignof(T);
+            if (placement != Placement::FIRST_TOUCH) align = std::max(align, PLACEMENT_ALIGNMENT);
             
-            pendingRequests.push_back({reinterpret_cast<void**>(targetPtr), sizeBytes, align, name});
+            pendingRequests.push_back({reinterpret_cast<void**>(targetPtr), sizeBytes, align, name, placement});
             
             // blockId is initialized to -1 while pending
-            trackingMap[name] = {sizeBytes, nullptr, true, false, -1};
+            trackingMap[name] = {sizeBytes, nullptr, true, false, -1, placement};
             totalPendingBytes += sizeBytes;
         }
 
         // Registers an allocation not owned by this allocator purely for profiling
         void trackExternal(const std::string& name, size_t sizeBytes, void* address = nullptr);
 
+        // Sets the huge page policy for the arenas built by later allocate() calls
+        void setHugePages(HugePages mode);
+
+        // Puts the arenas built by later allocate() calls in a temporary file in directory instead of RAM ("" for RAM)
+        // The file is sparse (so it still reads as zero until written) and deleted as soon as it is mapped, so it
+        // disappears with the process. The kernel pages the table in and out, which lets it grow past physical memory
+        // If the file cannot be made, a warning is printed and the arena lives in RAM after all
+        void setBackingDirectory(const std::string& directory);
+
+        // Writes the dirty pages of every file-backed arena back to disk and drops all of their pages from RAM
+        // Out-of-core solvers call it between blocks of work to hold their resident set to one block's worth
+        void releaseResident();
+
+        // Returns true if any arena lives in a file
+        bool hasFileBackedArenas() const;
+
         // Commits the allocations, building a single contiguous memory block
+        // The block is an anonymous mapping (VirtualAlloc on Windows), so it comes back zeroed without being
+        // touched: every page stays the shared zero page until its first write. Only if the mapping fails does
+        // it fall back to the heap plus a memset. With a backing directory set, the block is a sparse file instead
+        // Either way, every allocation starts out all zero bytes
         void allocate();
 
+        // Fills count elements with value, split over the pool so each thread first-touches its own pages
+        // Use it for non-zero starting values instead of a serial std::fill_n. Without a pool, a temporary one
+        // (one thread per core) is spun up for the fill
+        template <typename T>
+        static void fill(T* target, size_t count, const T& value, ThreadPool* pool = nullptr) {
+            if (count == 0) return;
+
+            if (pool == nullptr) {
+                ThreadPool localPool;
+                localPool.constructFrom(0);
+                fill(target, count, value, &localPool);
+                return;
+            }
+
+            // Chunks of 2 MB keep every huge page with a single thread
+            size_t chunk = std::max<size_t>(((size_t)2 << 20) / sizeof(T), 1);
+            pool->parallelFor(count, chunk, [&](unsigned int, size_t begin, size_t end) {
+                std::fill(target + begin, target + end, value);
+            });
+        }
+
+        // Parses a policy name as given on the command line ("none", "thp" or "reserved"). Returns false if it is not one
+        static bool parseHugePages(const std::string& name, HugePages* outMode);
+
+        // Parses a placement name as given on the command line ("first-touch", "interleave" or "partition")
+        // Returns false if it is not one
+        static bool parsePlacement(const std::string& name, Placement* outPlacement);
+
+        // Returns the number of NUMA nodes the placements spread over
+        int getNodeCount() const;
+
+        // Returns the number of arenas built so far, and the start and size (padding included) of arena i
+        // Arenas come in allocate() order, so a run that makes the same requests gets the same layout back
+        // (this is what lets a checkpoint save and restore the arenas whole)
+        size_t getArenaCount() const;
+        uint8_t* getArenaBase(size_t i) const;
+        size_t getArenaBytes(size_t i) const;
+
         // Prints the current memory state, including pending and active allocations
         void print() const;
 
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Graph.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class AutomorphismGroup {
+
+    /*
+        Explicit list of the automorphisms of a graph (every permutation of the nodes that preserves adjacency)
+        Used to fold symmetric (cop config, robber) states onto a single canonical representative
+        The group is either enumerated from the graph directly, or generated from a user-supplied generator file
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        int nodeCount;
+        size_t order;
+        int orbitCount;
+
+        // Constructors
+        AutomorphismGroup() : nodeCount(0), order(0), orbitCount(0), perms(nullptr), orbitReps(nullptr), cosetHeads(nullptr), cosets(nullptr) {}
+
+        // Destructor
+        ~AutomorphismGroup();
+
+        AutomorphismGroup(const AutomorphismGroup&) = delete;
+        AutomorphismGroup& operator=(const AutomorphismGroup&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Enumerates every automorphism of g by backtracking. If the group is larger than maxOrder,
+        // the search is abandoned and the trivial group is used instead. Returns false in that case
+        bool constructFrom(Graph* g, size_t maxOrder);
+
+        // Builds the group generated by the permutations in fileName (one per line, N space separated node images)
+        // Returns false (and falls back to the trivial group) if the file is unreadable, a permutation is not an
+        // automorphism of g, or the generated group is larger than maxOrder
+        bool constructFromGenerators(Graph* g, const char* fileName, size_t maxOrder);
+
+        // Returns the image table of the i-th automorphism (perm[v] is the image of node v)
+        inline const uint8_t* getPermutation(size_t i) const {
+            return &this->perms[i * this->nodeCount];
+        }
+
+        // Returns the smallest node in the orbit of node
+        inline int getOrbitRep(int node) const {
+            return this->orbitReps[node];
+        }
+
+        // Maps the state (config, r) to its canonical representative (outConfig, returned robber)
+        // The robber is mapped to its orbit representative, and outConfig is the lexicographically
+        // smallest sorted image of config over every automorphism that does so
+        int canonicalize(const uint8_t* config, int k, int r, uint8_t* outConfig) const;
+
+        // Returns true if config is the canonical config for a robber standing on the orbit representative r
+        bool isCanonical(const uint8_t* config, int k, int r) const;
+
+        // Returns the total memory footprint of the group tables in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        // order * nodeCount node images
+        uint8_t* perms;
+
+        // orbitReps[v] is the smallest node reachable from v
+        uint8_t* orbitReps;
+
+        // CSR lists of the automorphisms mapping v onto orbitReps[v]: cosets[cosetHeads[v] .. cosetHeads[v + 1])
+        size_t* cosetHeads;
+        uint32_t* cosets;
+
+
+        /*   Instance Functions   */
+
+        // Clears the tables and installs the identity as the only automorphism
+        void useTrivialGroup(int nodeCount);
+
+        // Builds orbitReps and the coset lists from perms
+        void buildOrbits();
+
+};
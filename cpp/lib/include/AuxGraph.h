@@ -2,16 +2,17 @@
 
 #include "AdjacencyList.h"
 #include "Allocator.h"
+#include "copconfig.h"
+#include "TransitionCache.h"
+#include "StateLayout.h"
 #include <vector>
 #include <cstdint>
 #include <cstring>
 #include <algorithm>
 #include <iostream>
 
-// Maximum supported number of cops to prevent stack overflow during generation
-constexpr size_t MAX_COPS = 256;
-
-template <typename StateData>
+// Layout decides where each (config, robber) state sits in the states table (see StateLayout.h)
+template <typename StateData, typename Layout = ConfigMajorLayout>
 class AuxGraph {
 public:
     int k;
@@ -19,9 +20,15 @@ public:
     size_t configCount;
     size_t numStates;
 
-    uint8_t* configs;
-    size_t* transitionHeads;
-    std::vector<size_t> transitions;
+    const uint8_t* configs;
+    CopConfigRanker ranker;
+
+    // Maps (cId, r) to a slot of states. Layout options (such as BlockedLayout::blockConfigs) are set before constructFrom
+    Layout layout;
+
+    // Configs and delta + varint encoded CSR rows of successor config IDs (decode with decodeCopTransitions)
+    // Mapped from the on-disk cache when one exists for this graph and k
+    TransitionCache table;
     
     // The tightly bundled AoS DP Table
     StateData* states;
@@ -29,23 +36,17 @@ public:
     const AdjacencyList* adj;
 
     AuxGraph() : k(0), N(0), configCount(0), numStates(0), configs(nullptr), 
-          transitionHeads(nullptr), states(nullptr), adj(nullptr), mem(nullptr) {}
+          states(nullptr), adj(nullptr), mem(nullptr) {}
 
     // Constructor: Generates configs, queues memory, and builds transitions
-    AuxGraph(int k, const AdjacencyList* adj, Allocator* mem) 
-        : k(k), N(N), configCount(0), numStates(0), configs(nullptr), 
-          transitionHeads(nullptr), states(nullptr), adj(adj), mem(mem) {
-        this->constructFrom(k, adj, mem);
+    AuxGraph(int k, const AdjacencyList* adj, Allocator* mem, const char* cacheFile = nullptr) 
+        : k(k), N(0), configCount(0), numStates(0), configs(nullptr), 
+          states(nullptr), adj(adj), mem(mem) {
+        this->constructFrom(k, adj, mem, cacheFile);
     }
 
-    // Destructor: Cleans up the raw transitionHeads array
-    ~AuxGraph() {
-        delete[] this->transitionHeads;
-    }
-    
-
-    // Deferred constructor
-    void constructFrom(int k, const AdjacencyList* adj, Allocator* mem) {
+    // Deferred constructor. cacheFile (optional) is the transition cache to map, or to write for the next run
+    void constructFrom(int k, const AdjacencyList* adj, Allocator* mem, const char* cacheFile = nullptr) {
 
         if (mem == nullptr || adj == nullptr) return;
 
@@ -54,31 +55,50 @@ public:
         this->adj = adj;
         this->mem = mem;
 
-        // 1. Generate Configurations
-        this->generateCopConfigs();
-        
+        // 1. Rank Configurations
+        if (this->k <= 0 || this->k > static_cast<int>(MAX_COPS)) {
+            std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+            return;
+        }
+
+        this->ranker.constructFrom(this->k, this->N);
+        this->configCount = this->ranker.configCount;
         if (this->configCount == 0) return;
-        this->numStates = this->configCount * N;
+
+        // 2. Map or Build the Configs and Transition Table
+        this->createTransitions(cacheFile);
+        if (this->configCount == 0) return;
+
+        // 3. Per State Data (numStates includes any padding the layout needs)
+        this->layout.constructFrom(this->configCount, this->N);
+        this->numStates = this->layout.numStates;
 
         this->mem->requestAlloc<StateData>("AuxGraph Per State Data", this->numStates, &this->states);
         this->mem->allocate();
 
-        // 3. Build the Transition Table
-        this->createTransitions();
-
     }
 
     // --- Core Accessors ---
 
     // Maps a cop configuration ID and a robber position to a 1D state ID
     inline StateData* getState(size_t cId, int r) const {
-        return &(this->states[cId * N + r]);
+        return &(this->states[this->layout.getStateId(cId, r)]);
+    }
+
+    // Maps a cop configuration ID and a robber position to a 1D state index
+    inline size_t getStateId(size_t cId, int r) const {
+        return this->layout.getStateId(cId, r);
     }
 
-    // Fetches the exact transition boundaries for a given cop configuration
-    inline void getCopTransitions(size_t cId, size_t& startIdx, size_t& endIdx) const {
-        startIdx = transitionHeads[cId];
-        endIdx = transitionHeads[cId + 1];
+    // Maps a 1D state index back to its cop configuration ID and robber position
+    inline void splitStateId(size_t stateId, size_t* cId, int* r) const {
+        this->layout.splitStateId(stateId, cId, r);
+    }
+
+    // Decodes the team moves of a cop configuration into out as successor config IDs (index with getStateId)
+    // out must hold table.transitions.maxRowLength entries. Returns the number of moves written
+    inline size_t decodeCopTransitions(size_t cId, size_t* out) const {
+        return this->table.transitions.decodeRow(cId, out);
     }
 
     // Evaluates if a specific state is an instant capture
@@ -93,159 +113,25 @@ public:
 private:
     Allocator* mem;
 
-    void generateCopConfigs() {
-        if (this->k <= 0 || this->k > static_cast<int>(MAX_COPS)) {
-            std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
-            this->configCount = 0;
-            return;
-        }
+    void createTransitions(const char* cacheFile) {
 
-        int n_val = this->N + this->k - 1;
-        int k_val = this->k;
-        
-        if (k_val > n_val) {
-            this->configCount = 0;
-        } else if (k_val == 0 || k_val == n_val) {
-            this->configCount = 1;
-        } else {
-            if (k_val > n_val / 2) k_val = n_val - k_val;
-            size_t res = 1;
-            for (int i = 1; i <= k_val; ++i) {
-                res = res * (n_val - i + 1) / i;
-            }
-            this->configCount = res;
-        }
-        
-        if (this->configCount == 0) return;
-
-        size_t totalBytes = this->configCount * this->k;
-        
-        if (this->mem != nullptr) {
-            this->mem->requestAlloc<uint8_t>("Cop Configs", totalBytes, &this->configs);
-            this->mem->allocate();
-        } else {
-            std::cerr << "FATAL: Allocator pointer is null.\n";
+        // A freshly built table goes straight into Allocator arenas, so the report already covers it
+        if (!this->table.constructFrom(this->adj, &this->ranker, cacheFile, this->mem)) {
             this->configCount = 0;
             return;
         }
+        this->configs = this->table.configs;
 
-        if (this->configs == nullptr) return;
-        
-        uint8_t current[MAX_COPS];
-        std::memset(current, 0, MAX_COPS);
-        
-        size_t offset = 0;
-        
-        while(true) {
-            std::memcpy(&(this->configs[offset]), current, this->k);
-            offset += this->k;
-            
-            int p = this->k - 1;
-            while(p >= 0 && current[p] == this->N - 1) {
-                p--;
-            }
-            
-            if (p < 0) break; 
-            
-            current[p]++;
-            
-            for(uint32_t i = p + 1; i < (uint32_t)this->k; ++i) {
-                current[i] = current[p];
-            }
-        }
-    }
-
-    void createTransitions() {
-        this->transitionHeads = new size_t[this->configCount + 1]();
-        this->transitions.reserve(this->configCount * 8); 
-
-        std::vector<size_t> tempMoves;
-        tempMoves.reserve(1024); 
-        size_t peakTempMovesCapacity = 0;
-
-        std::cout << "Building AuxGraph transition table for " << this->configCount << " configurations...\n";
-
-        uint8_t options[MAX_COPS][256];
-        int optionCount[MAX_COPS];
-        int odometer[MAX_COPS];
-        uint8_t moveConfig[MAX_COPS];
-
-        for (size_t cId = 0; cId < this->configCount; cId++) {
-            tempMoves.clear(); 
-            const uint8_t* currentCops = &this->configs[cId * this->k];
-            
-            for (int i = 0; i < this->k; i++) {
-                uint8_t u = currentCops[i];
-                options[i][0] = u; 
-                int count = 1;
-                
-                uint8_t* edges = this->adj->getEdges(u);
-                int eIdx = 0;
-                while (edges[eIdx] != 255) {
-                    options[i][count++] = edges[eIdx++];
-                }
-                optionCount[i] = count;
-            }
+        if (this->mem != nullptr) {
+            this->mem->trackExternal("AuxGraph: Config Ranker", this->ranker.getMemoryFootprint());
 
-            std::memset(odometer, 0, MAX_COPS * sizeof(int));
-            
-            while (true) {
-                for (int i = 0; i < this->k; ++i) {
-                    moveConfig[i] = options[i][odometer[i]];
-                }
-                
-                std::sort(moveConfig, moveConfig + this->k);
-                size_t nextId = static_cast<size_t>(-1); 
-                size_t left = 0;
-                size_t right = this->configCount - 1;
-                
-                while (left <= right) {
-                    size_t mid = left + (right - left) / 2;
-                    int cmp = std::memcmp(&this->configs[mid * this->k], moveConfig, this->k);
-                    if (cmp == 0) {
-                        nextId = mid;
-                        break;
-                    }
-                    if (cmp < 0) {
-                        left = mid + 1;
-                    } else {
-                        right = mid - 1;
-                    }
-                }
-                
-                tempMoves.push_back(nextId * this->N);
-                
-                int p = this->k - 1;
-                while (p >= 0) {
-                    odometer[p]++;
-                    if (odometer[p] < optionCount[p]) break;
-                    odometer[p] = 0;
-                    p--;
-                }
-                if (p < 0) break;
+            if (this->table.loadedFromDisk) {
+                this->mem->trackExternal("AuxGraph: Transition Cache (Mapped)", this->table.getMappedBytes());
             }
-
-            std::sort(tempMoves.begin(), tempMoves.end());
-            tempMoves.erase(std::unique(tempMoves.begin(), tempMoves.end()), tempMoves.end());
-
-            peakTempMovesCapacity = std::max(peakTempMovesCapacity, tempMoves.capacity());
-            
-            this->transitions.insert(this->transitions.end(), tempMoves.begin(), tempMoves.end());
-            this->transitionHeads[cId + 1] = this->transitions.size();
-        }
-
-        this->transitions.shrink_to_fit();
-
-        if (this->mem != nullptr) {
-            size_t headsBytes = (this->configCount + 1) * sizeof(size_t);
-            size_t transitionsBytes = this->transitions.capacity() * sizeof(size_t);
-            size_t peakTempBytes = peakTempMovesCapacity * sizeof(size_t);
-            
-            this->mem->trackExternal("AuxGraph: Heads", headsBytes, this->transitionHeads);
-            this->mem->trackExternal("AuxGraph: Edges", transitionsBytes, this->transitions.data());
-            this->mem->trackExternal("tempMoves (Peak Buffer)", peakTempBytes, nullptr);
         }
 
-        std::cout << "Transitions generated. Total edge pointers: " << this->transitions.size() << "\n";
+        std::cout << "Transitions ready. Total edges: " << this->table.transitions.edgeCount
+                  << " (" << this->table.transitions.encodedBytes << " bytes encoded, "
+                  << this->table.transitions.edgeCount * sizeof(size_t) << " bytes uncompressed)\n";
     }
-};
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Checkpoint {
+
+    /*
+        A crash-safe copy of a solver's working memory on disk, written between waves and read back to resume
+        The solver registers the memory regions that hold its state (the Allocator arenas) and saves them along with
+        a handful of progress counters. Whatever else it needs is rebuilt from the same inputs on resume
+
+        The file holds two slots, each a header plus a copy of every region. Saves alternate between the slots, and a
+        slot's header is only written after its data has reached the disk, so the other slot always holds the last
+        complete checkpoint wherever a crash cuts a save short. load() takes the newest slot with a valid header
+
+        Saves are incremental: each page of each region keeps a 64-bit hash of what either slot holds, and a save only
+        writes the pages whose hash no longer matches its slot's. Hashing works the same on every platform and every
+        kind of arena (file-backed ones included), at the cost of reading the regions once per save
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        // Saves completed so far, and the bytes written by the last one and by all of them
+        size_t saveCount;
+        uint64_t lastWrittenBytes;
+        uint64_t totalWrittenBytes;
+
+        // Sequence number of the newest complete slot in the file (0 if none)
+        uint64_t sequence;
+
+        // Constructors
+        Checkpoint() : saveCount(0), lastWrittenBytes(0), totalWrittenBytes(0), sequence(0), fingerprint(0),
+                       slotBytes(0), hashesKnown{false, false}, fileHandle(-1) {}
+
+        // Destructor closes the file (which is kept, so a later run can resume from it)
+        ~Checkpoint();
+
+        Checkpoint(const Checkpoint&) = delete;
+        Checkpoint& operator=(const Checkpoint&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Opens the checkpoint file at path, keeping its contents if resume is set and starting
+        // an empty one otherwise. fingerprint identifies the problem being solved: load() refuses a file made for
+        // another one. Returns false if the file could not be opened
+        bool constructFrom(const std::string& path, uint64_t fingerprint, bool resume);
+
+        // Registers a region to save. All of them must be added before the first load() or save()
+        void addRegion(void* base, size_t bytes);
+
+        // Reads the newest complete checkpoint back into the regions, and its counters into counters
+        // Returns false (regions left as they were, apart from a failed read) if there is none that matches the
+        // fingerprint and the region sizes
+        bool load(ThreadPool& pool, std::vector<uint64_t>* counters);
+
+        // Writes the regions (only pages changed since this slot was last written) and counters to the older slot
+        // Returns false if a write failed, in which case the newer slot is still intact
+        bool save(ThreadPool& pool, const std::vector<uint64_t>& counters);
+
+        // Returns the total size of the registered regions in bytes
+        uint64_t getRegionBytes() const;
+
+        // Returns the memory footprint of the page hashes in bytes
+        size_t getMemoryFootprint() const;
+
+        // Returns a 64-bit hash of bytes, continuing from seed (for fingerprints as well as page hashes)
+        static uint64_t hashBytes(const void* data, size_t bytes, uint64_t seed = 0);
+
+    private:
+
+        // One registered region, with the offset of its copy inside a slot and one hash per page for each slot
+        struct Region {
+            uint8_t* base;
+            size_t bytes;
+            uint64_t slotOffset;
+            std::vector<uint64_t> pageHashes[2];
+        };
+
+        /*   Instance Variables   */
+
+        std::vector<Region> regions;
+        uint64_t fingerprint;
+
+        // Bytes of one slot's data, and whether the page hashes of each slot reflect what it holds
+        uint64_t slotBytes;
+        bool hashesKnown[2];
+
+        // Descriptor (a HANDLE on Windows) of the checkpoint file
+        intptr_t fileHandle;
+
+
+        /*   Instance Functions   */
+
+        // File offset of slot's header and of its data
+        uint64_t getHeaderOffset(int slot) const;
+        uint64_t getDataOffset(int slot) const;
+
+        // Writes or reads bytes at offset of the file. Return false on failure
+        bool writeAt(uint64_t offset, const void* data, size_t bytes);
+        bool readAt(uint64_t offset, void* data, size_t bytes) const;
+
+        // Sets the file's size (growing it leaves a hole that reads as zero). Returns false on failure
+        bool resize(uint64_t bytes);
+
+        // Forces everything written so far onto the disk. Returns false on failure
+        bool sync();
+
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CompressedTransitions {
+
+    /*
+        Compressed Sparse Row table of cop team moves
+        Each row is a sorted, deduplicated list of config IDs, stored as the first ID followed by the gaps
+        between neighbours, every value LEB128 varint encoded (7 bits per byte, high bit = more bytes follow)
+        Rows are decoded sequentially, so this trades a few shifts per edge for 4-8x less memory bandwidth
+        The table either owns its rows, or is a read-only view over external memory (see attach)
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t rowCount;
+        size_t edgeCount;
+        size_t maxRowLength;
+        size_t encodedBytes;
+
+        // Constructors
+        CompressedTransitions() : rowCount(0), edgeCount(0), maxRowLength(0), encodedBytes(0),
+                                  headsView(nullptr), dataView(nullptr) {}
+
+        // Copying would leave the views pointing into the source, so only moves are allowed
+        CompressedTransitions(const CompressedTransitions&) = delete;
+        CompressedTransitions& operator=(const CompressedTransitions&) = delete;
+        CompressedTransitions(CompressedTransitions&& other) noexcept;
+        CompressedTransitions& operator=(CompressedTransitions&& other) noexcept;
+
+
+        /*   Instance Functions   */
+
+        // Clears the table and reserves space for rowCount rows (byteGuess is the expected encoded size)
+        void reserve(size_t rowCount, size_t byteGuess);
+
+        // Appends the next row. ids must be sorted ascending with no duplicates
+        void appendRow(const size_t* ids, size_t count);
+
+        // Returns the number of bytes ids take once encoded as a row (sorted ascending, no duplicates)
+        static size_t encodedRowSize(const size_t* ids, size_t count);
+
+        // Encodes ids as a row into out, which must hold encodedRowSize(ids, count) bytes
+        static void encodeRow(const size_t* ids, size_t count, uint8_t* out);
+
+        // Drops any owned rows and views rowCount rows laid out in external memory (heads holds rowCount + 1 byte offsets)
+        // The memory is not copied, so it must outlive this table
+        void attach(const size_t* heads, const uint8_t* data, size_t rowCount, size_t edgeCount, size_t maxRowLength);
+
+        // Raw row heads (rowCount + 1 byte offsets into getData)
+        inline const size_t* getHeads() const {
+            return this->headsView;
+        }
+
+        // Raw encoded rows (encodedBytes bytes)
+        inline const uint8_t* getData() const {
+            return this->dataView;
+        }
+
+        // Calls visit(id) for every ID of row, in ascending order
+        template <typename Visitor>
+        inline void forEachInRow(size_t row, Visitor&& visit) const {
+            const uint8_t* p = this->dataView + this->headsView[row];
+            const uint8_t* end = this->dataView + this->headsView[row + 1];
+
+            size_t value = 0;
+            while (p < end) {
+                size_t delta = 0;
+                int shift = 0;
+                uint8_t byte;
+                do {
+                    byte = *p++;
+                    delta |= static_cast<size_t>(byte & 0x7F) << shift;
+                    shift += 7;
+                } while (byte & 0x80);
+
+                value += delta;
+                visit(value);
+            }
+        }
+
+        // Decodes row into out (which must hold maxRowLength entries), multiplying every ID by scale.
+        // Returns the number of entries written
+        inline size_t decodeRow(size_t row, size_t* out, size_t scale = 1) const {
+            size_t count = 0;
+            this->forEachInRow(row, [&](size_t id) { out[count++] = id * scale; });
+            return count;
+        }
+
+        // Returns the total memory footprint of the owned row heads in bytes (0 for an attached view)
+        size_t getHeadsFootprint() const;
+
+        // Returns the total memory footprint of the owned encoded rows in bytes (0 for an attached view)
+        size_t getDataFootprint() const;
+
+        // Returns the memory the same table would take as an uncompressed size_t CSR, in bytes
+        size_t getUncompressedFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        // Byte offset of each row within data (rowCount + 1 entries)
+        std::vector<size_t> heads;
+        std::vector<uint8_t> data;
+
+        // What decoding reads from. Points into heads / data, or into attached external memory
+        const size_t* headsView;
+        const uint8_t* dataView;
+
+
+        /*   Instance Functions   */
+
+        // Points the views back at the owned vectors after they change
+        void refreshViews();
+
+};
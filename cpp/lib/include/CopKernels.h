@@ -0,0 +1,445 @@
+#pragma once
+
+#include "AdjacencyList.h"
+#include "copconfig.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// Largest team size with its own compiled kernel. Bigger teams run the generic kernel
+constexpr int MAX_SPECIALISED_COPS = 8;
+
+
+// Optimal sorting networks for up to 8 elements, as (low, high) index pairs
+template <int K> struct SortingNetwork;
+
+template <> struct SortingNetwork<1> {
+    static constexpr int SIZE = 0;
+    static constexpr uint8_t PAIRS[1][2] = {{0, 0}};
+};
+template <> struct SortingNetwork<2> {
+    static constexpr int SIZE = 1;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 1}};
+};
+template <> struct SortingNetwork<3> {
+    static constexpr int SIZE = 3;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 2}, {0, 1}, {1, 2}};
+};
+template <> struct SortingNetwork<4> {
+    static constexpr int SIZE = 5;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}};
+};
+template <> struct SortingNetwork<5> {
+    static constexpr int SIZE = 9;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3}};
+};
+template <> struct SortingNetwork<6> {
+    static constexpr int SIZE = 12;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3},
+                                               {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}};
+};
+template <> struct SortingNetwork<7> {
+    static constexpr int SIZE = 16;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5},
+                                               {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2}, {3, 4}, {5, 6}};
+};
+template <> struct SortingNetwork<8> {
+    static constexpr int SIZE = 19;
+    static constexpr uint8_t PAIRS[SIZE][2] = {{0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {0, 1}, {2, 3},
+                                               {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+};
+
+
+template <int K>
+struct CopMaskSet {
+
+    /*
+        A set of cop subsets, one bit per subset (bit m stands for the cops in mask m)
+        Used by the distinct team move enumeration to track which cops could have produced the values picked so far
+        Sets of up to 6 cops fit in one word, 8 cops take four
+    */
+
+    static constexpr int WORDS = (K <= 6) ? 1 : (1 << (K - 6));
+
+    // LOW_HAS[i] marks the masks holding cop i within one word (cops 6 and 7 select whole words instead)
+    static constexpr uint64_t LOW_HAS[6] = {0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+                                            0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+
+    uint64_t words[WORDS];
+
+    // Resets the set to hold only the empty subset
+    inline void setEmptySubset() {
+        for (int w = 0; w < WORDS; ++w) this->words[w] = 0;
+        this->words[0] = 1;
+        return;
+    }
+
+    inline void clear() {
+        for (int w = 0; w < WORDS; ++w) this->words[w] = 0;
+        return;
+    }
+
+    inline bool isEmpty() const {
+        uint64_t any = 0;
+        for (int w = 0; w < WORDS; ++w) any |= this->words[w];
+        return any == 0;
+    }
+
+    // Returns the cops missing from at least one subset in the set (the cops a next value could still go to)
+    inline uint8_t getOpenCops() const {
+        uint8_t open = 0;
+        for (int cop = 0; cop < K; ++cop) {
+            uint64_t lacking = 0;
+            if (cop < 6) {
+                for (int w = 0; w < WORDS; ++w) lacking |= this->words[w] & ~LOW_HAS[cop];
+            } else {
+                int bit = 1 << (cop - 6);
+                for (int w = 0; w < WORDS; ++w) {
+                    if (!(w & bit)) lacking |= this->words[w];
+                }
+            }
+            if (lacking != 0) open |= static_cast<uint8_t>(1 << cop);
+        }
+        return open;
+    }
+
+    // Adds m + {cop} for every m in from that does not hold cop yet
+    inline void addWithCop(const CopMaskSet& from, int cop) {
+        if (cop < 6) {
+            for (int w = 0; w < WORDS; ++w) {
+                this->words[w] |= (from.words[w] & ~LOW_HAS[cop]) << (1 << cop);
+            }
+        } else {
+            int bit = 1 << (cop - 6);
+            for (int w = 0; w < WORDS; ++w) {
+                if (!(w & bit)) this->words[w | bit] |= from.words[w];
+            }
+        }
+        return;
+    }
+
+    // Drops every subset that is missing one of the cops in required
+    inline void keepSupersetsOf(uint8_t required) {
+        for (int cop = 0; cop < K; ++cop) {
+            if (!((required >> cop) & 1)) continue;
+            if (cop < 6) {
+                for (int w = 0; w < WORDS; ++w) this->words[w] &= LOW_HAS[cop];
+            } else {
+                int bit = 1 << (cop - 6);
+                for (int w = 0; w < WORDS; ++w) {
+                    if (!(w & bit)) this->words[w] = 0;
+                }
+            }
+        }
+        return;
+    }
+
+};
+
+
+template <int K>
+struct CopKernel {
+
+    /*
+        Hot per-configuration loops of the solvers, compiled for a fixed team size K
+        With K known, the odometer becomes K nested loops, the sort a branchless sorting network and ranking
+        K straight-line lookups, and the scratch arrays shrink from MAX_COPS rows to K
+        Team moves are enumerated as distinct sorted multisets with the rank built up one slot at a time, so no
+        move is sorted, ranked from scratch or visited twice
+        K == 0 is the generic kernel, which reads the team size from its k argument at runtime
+        Pick a kernel with dispatchCopKernel rather than naming one directly
+    */
+
+    static constexpr int COPS = K;
+
+    // Rows of scratch space a kernel needs on the stack
+    static constexpr int CAPACITY = (K > 0) ? K : static_cast<int>(MAX_COPS);
+
+    // True if forEachTeamMove visits every config once, in ascending order (every kernel but the generic one)
+    static constexpr bool DISTINCT_MOVES = (K > 0 && K <= MAX_SPECIALISED_COPS);
+
+    // Returns the team size to loop over (the compile-time K, or k for the generic kernel)
+    static constexpr int count(int k) {
+        return (K > 0) ? K : k;
+    }
+
+    // Sorts a config of count(k) cops in place
+    static inline void sortConfig(uint8_t* config, int k) {
+        if constexpr (K > 0 && K <= MAX_SPECIALISED_COPS) {
+            for (int i = 0; i < SortingNetwork<K>::SIZE; ++i) {
+                uint8_t& a = config[SortingNetwork<K>::PAIRS[i][0]];
+                uint8_t& b = config[SortingNetwork<K>::PAIRS[i][1]];
+                uint8_t lo = std::min(a, b);
+                uint8_t hi = std::max(a, b);
+                a = lo;
+                b = hi;
+            }
+        } else {
+            std::sort(config, config + count(k));
+        }
+        return;
+    }
+
+    // Returns the number of team moves out of currentCops (the Cartesian product of every cop's stay-or-move choices)
+    // Saturates rather than overflowing for very large k
+    static inline uint64_t countTeamMoves(const uint8_t* currentCops, int k, const AdjacencyList& adj) {
+        uint64_t product = 1;
+        for (int i = 0; i < count(k); ++i) {
+            uint8_t* edges = adj.getEdges(currentCops[i]);
+            uint64_t options = 1;
+            while (edges[options - 1] != 255) options++;
+            product = (product > UINT64_MAX / options) ? UINT64_MAX : product * options;
+        }
+        return product;
+    }
+
+    // Calls visit(moveConfig) for every team move out of currentCops, in odometer order
+    // moveConfig is unsorted (slot i holds where cop i went) and only valid during the call
+    template <typename Visitor>
+    static inline void forEachTeamConfig(const uint8_t* currentCops, int k, const AdjacencyList& adj, Visitor&& visit) {
+
+        const int cops = count(k);
+
+        uint8_t options[CAPACITY][256];
+        int optionCount[CAPACITY];
+        uint8_t moveConfig[CAPACITY];
+
+        for (int i = 0; i < cops; ++i) {
+            uint8_t u = currentCops[i];
+            options[i][0] = u;
+            int optionIdx = 1;
+
+            uint8_t* edges = adj.getEdges(u);
+            int eIdx = 0;
+            while (edges[eIdx] != 255) {
+                options[i][optionIdx++] = edges[eIdx++];
+            }
+            optionCount[i] = optionIdx;
+        }
+
+        if constexpr (K > 0) {
+            odometerLevel<0>(options, optionCount, moveConfig, visit);
+        } else {
+            int odometer[CAPACITY];
+            std::fill(odometer, odometer + cops, 0);
+
+            while (true) {
+                for (int i = 0; i < cops; ++i) moveConfig[i] = options[i][odometer[i]];
+                visit(static_cast<const uint8_t*>(moveConfig));
+
+                int p = cops - 1;
+                while (p >= 0) {
+                    odometer[p]++;
+                    if (odometer[p] < optionCount[p]) break;
+                    odometer[p] = 0;
+                    p--;
+                }
+                if (p < 0) break;
+            }
+        }
+
+        return;
+
+    }
+
+    // Calls visit(nextId) with the config ID of every team move out of currentCops
+    // With DISTINCT_MOVES every reachable config is visited exactly once, in ascending order. The generic kernel
+    // visits in odometer order, and since different moves can land on the same config, IDs may repeat
+    template <typename Visitor>
+    static inline void forEachTeamMove(const uint8_t* currentCops, int k, const AdjacencyList& adj, const CopConfigRanker& ranker,
+                                       Visitor&& visit) {
+
+        if constexpr (DISTINCT_MOVES) {
+
+            MoveCandidates candidates;
+            candidates.constructFrom(currentCops, adj);
+
+            CopMaskSet<K> start;
+            start.setEmptySubset();
+            distinctLevel<0>(candidates, 0, start, ranker.configCount, ranker, visit);
+
+        } else {
+
+            uint8_t sorted[CAPACITY];
+
+            forEachTeamConfig(currentCops, k, adj, [&](const uint8_t* moveConfig) {
+                std::copy(moveConfig, moveConfig + count(k), sorted);
+                sortConfig(sorted, k);
+                visit(ranker.template rank<K>(sorted));
+            });
+
+        }
+
+        return;
+
+    }
+
+    private:
+
+        struct MoveCandidates {
+
+            // Every node some cop can reach, ascending, stored once however many cops reach it
+            int count;
+            uint8_t nodes[256];
+
+            // coverMasks[idx] holds the cops that can reach nodes[idx]. deadMasks[idx] holds the cops whose
+            // options all lie below nodes[idx], which can never take that slot or any later one
+            uint8_t coverMasks[256];
+            uint8_t deadMasks[256];
+
+            // copOptions[i] lists the candidate indices cop i can reach, ascending
+            uint8_t copOptions[K][256];
+            int copOptionCount[K];
+
+            inline void constructFrom(const uint8_t* currentCops, const AdjacencyList& adj) {
+
+                uint8_t coverByNode[256];
+                uint8_t lastOption[K];
+
+                int lo = 255;
+                int hi = 0;
+                for (int i = 0; i < K; ++i) {
+                    uint8_t u = currentCops[i];
+                    uint8_t* edges = adj.getEdges(u);
+                    int cLo = u;
+                    int cHi = u;
+                    for (int eIdx = 0; edges[eIdx] != 255; ++eIdx) {
+                        cLo = std::min(cLo, static_cast<int>(edges[eIdx]));
+                        cHi = std::max(cHi, static_cast<int>(edges[eIdx]));
+                    }
+                    lastOption[i] = static_cast<uint8_t>(cHi);
+                    lo = std::min(lo, cLo);
+                    hi = std::max(hi, cHi);
+                }
+
+                std::fill(coverByNode + lo, coverByNode + hi + 1, 0);
+                for (int i = 0; i < K; ++i) {
+                    uint8_t u = currentCops[i];
+                    coverByNode[u] |= static_cast<uint8_t>(1 << i);
+                    uint8_t* edges = adj.getEdges(u);
+                    for (int eIdx = 0; edges[eIdx] != 255; ++eIdx) {
+                        coverByNode[edges[eIdx]] |= static_cast<uint8_t>(1 << i);
+                    }
+                    this->copOptionCount[i] = 0;
+                }
+
+                this->count = 0;
+                uint8_t dead = 0;
+                for (int v = lo; v <= hi; ++v) {
+                    uint8_t cover = coverByNode[v];
+                    if (cover == 0) continue;
+
+                    for (int i = 0; i < K; ++i) {
+                        if (lastOption[i] < v) dead |= static_cast<uint8_t>(1 << i);
+                        if ((cover >> i) & 1) this->copOptions[i][this->copOptionCount[i]++] = static_cast<uint8_t>(this->count);
+                    }
+
+                    this->nodes[this->count] = static_cast<uint8_t>(v);
+                    this->coverMasks[this->count] = cover;
+                    this->deadMasks[this->count] = dead;
+                    this->count++;
+                }
+
+                return;
+
+            }
+
+        };
+
+        // Picks slot J of the sorted team move, from candidate startIdx onwards (slots never decrease, so every
+        // multiset is built exactly once). masks holds the cop subsets that could have produced slots 0..J-1, and
+        // the rank grows by slot J's weight as it goes, so a finished config is ranked in O(1)
+        // A subset missing a dead cop can never be completed, so it is dropped. Every other subset can (each missing
+        // cop takes its last option), so the walk never dead ends
+        template <int J, typename Visitor>
+        static inline void distinctLevel(const MoveCandidates& candidates, int startIdx, const CopMaskSet<K>& masks, size_t id,
+                                         const CopConfigRanker& ranker, Visitor& visit) {
+
+            uint8_t openCops = masks.getOpenCops();
+
+            // Last slot: a node is reachable iff an unplaced cop reaches it. That cop can not be dead there, and every
+            // subset missing just it holds all the others, so no dead cop checks are needed. With a single cop left
+            // (the common case), its own option list is exactly the answer
+            if constexpr (J == K - 1) {
+                if ((openCops & (openCops - 1)) == 0) {
+                    int cop = __builtin_ctz(openCops);
+                    const uint8_t* options = candidates.copOptions[cop];
+                    for (int j = 0; j < candidates.copOptionCount[cop]; ++j) {
+                        if (options[j] < startIdx) continue;
+                        visit(id + ranker.getWeight(J, candidates.nodes[options[j]]));
+                    }
+                } else {
+                    for (int idx = startIdx; idx < candidates.count; ++idx) {
+                        if (candidates.coverMasks[idx] & openCops) {
+                            visit(id + ranker.getWeight(J, candidates.nodes[idx]));
+                        }
+                    }
+                }
+            } else {
+
+                // Subsets that still hold every dead cop, refreshed whenever another cop dies (dead cops only pile up
+                // as the values grow, so once none survive, no later candidate can either)
+                CopMaskSet<K> live = masks;
+                uint8_t dead = 0;
+
+                for (int idx = startIdx; idx < candidates.count; ++idx) {
+                    if (candidates.deadMasks[idx] != dead) {
+                        dead = candidates.deadMasks[idx];
+                        live.keepSupersetsOf(dead);
+                        if (live.isEmpty()) break;
+                        openCops = live.getOpenCops();
+                    }
+
+                    // Some subset lacks each of these cops, so the extended set can not come out empty
+                    uint8_t cover = candidates.coverMasks[idx] & openCops;
+                    if (cover == 0) continue;
+
+                    CopMaskSet<K> next;
+                    next.clear();
+                    for (int i = 0; i < K; ++i) {
+                        if ((cover >> i) & 1) next.addWithCop(live, i);
+                    }
+
+                    distinctLevel<J + 1>(candidates, idx, next, id + ranker.getWeight(J, candidates.nodes[idx]), ranker, visit);
+                }
+
+            }
+
+            return;
+
+        }
+
+        // One loop of the odometer per cop, unrolled by recursion on the slot I
+        template <int I, typename Visitor>
+        static inline void odometerLevel(const uint8_t (*options)[256], const int* optionCount, uint8_t* moveConfig, Visitor& visit) {
+            if constexpr (I == K) {
+                visit(static_cast<const uint8_t*>(moveConfig));
+            } else {
+                for (int j = 0; j < optionCount[I]; ++j) {
+                    moveConfig[I] = options[I][j];
+                    odometerLevel<I + 1>(options, optionCount, moveConfig, visit);
+                }
+            }
+            return;
+        }
+
+};
+
+// Calls body(CopKernel<k>()) when 1 <= k <= MAX_SPECIALISED_COPS, and body(CopKernel<0>()) otherwise
+// Dispatch once around a hot loop, not inside it. Inside body, decltype(kernel)::COPS is the compile-time team size
+template <typename Body>
+inline void dispatchCopKernel(int k, Body&& body) {
+    switch (k) {
+        case 1: body(CopKernel<1>()); break;
+        case 2: body(CopKernel<2>()); break;
+        case 3: body(CopKernel<3>()); break;
+        case 4: body(CopKernel<4>()); break;
+        case 5: body(CopKernel<5>()); break;
+        case 6: body(CopKernel<6>()); break;
+        case 7: body(CopKernel<7>()); break;
+        case 8: body(CopKernel<8>()); break;
+        default: body(CopKernel<0>()); break;
+    }
+    return;
+}
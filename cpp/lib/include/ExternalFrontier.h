@@ -0,0 +1,126 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ExternalFrontier {
+
+    /*
+        A set of state IDs that may outgrow RAM, collected by many threads and read back once in ascending order
+        Each thread appends to its own buffer. A full buffer is sorted, deduplicated and written to a spill file as
+        one run of 32-bit IDs (64-bit once the state space passes 2^32), so memory stays at the buffers' worth
+        however many IDs come in. drain() then k-way merges every run, spilled or still buffered, and hands the
+        IDs out in ascending state order without repeats, which is also the order of the state table on disk
+        The read windows of one merge share a quarter of the memory. When there are too many runs for that, drain()
+        first merges them down in groups, each pass writing the merged groups as new, fewer runs behind the old ones
+
+        The spill file is a temporary file in the given directory, deleted as soon as it is opened, and emptied
+        again by every drain()
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t numStates;
+
+        // True if IDs are stored with 64 bits on disk (the state space does not fit 32)
+        bool wideIds;
+
+        // IDs a thread buffers before it spills them
+        size_t bufferEntries;
+
+        // Runs written and bytes spilled over the whole solve, merge passes included (not reset by drain())
+        size_t totalSpilledRuns;
+        uint64_t totalSpilledBytes;
+
+        // Extra merge passes drain() needed to bring the runs down to what one merge can read
+        size_t totalMergePasses;
+
+        // Constructors
+        ExternalFrontier() : numStates(0), wideIds(false), bufferEntries(0), totalSpilledRuns(0), totalSpilledBytes(0),
+                             totalMergePasses(0), memoryBytes(0), fileHandle(-1), fileEnd(0) {}
+
+        // Destructor closes (and so deletes) the spill file
+        ~ExternalFrontier();
+
+        ExternalFrontier(const ExternalFrontier&) = delete;
+        ExternalFrontier& operator=(const ExternalFrontier&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Buffers for numThreads threads share memoryBytes, spilling to a file in directory
+        // Returns false if the spill file could not be created
+        bool constructFrom(const std::string& directory, size_t numStates, unsigned int numThreads, size_t memoryBytes);
+
+        // Adds a state, spilling the thread's buffer once it is full. Thread tId only
+        inline void push(unsigned int tId, size_t state) {
+            std::vector<uint64_t>& buffer = this->buffers[tId];
+            buffer.push_back(state);
+            if (buffer.size() >= this->bufferEntries) this->spill(tId);
+        }
+
+        // Merges everything pushed since the last drain and calls consume(ids, count) on batches of at most
+        // batchEntries ascending, distinct IDs. The buffered runs are sorted on pool first
+        // Afterwards the frontier is empty again. Returns the number of distinct IDs handed out
+        size_t drain(ThreadPool& pool, size_t batchEntries, const std::function<void(const uint64_t*, size_t)>& consume);
+
+        // Returns the number of runs waiting in the spill file
+        size_t getSpilledRunCount() const;
+
+        // Returns the memory footprint of the buffers in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        // One sorted run in the spill file
+        struct Run {
+            uint64_t offset;
+            size_t count;
+        };
+
+        /*   Instance Variables   */
+
+        size_t memoryBytes;
+        std::vector<std::vector<uint64_t>> buffers;
+
+        std::mutex runsMutex;
+        std::vector<Run> runs;
+
+        // Descriptor (a HANDLE on Windows) of the spill file, and the end of what has been written to it
+        intptr_t fileHandle;
+        std::atomic<uint64_t> fileEnd;
+
+
+        /*   Instance Functions   */
+
+        // Sorts, deduplicates and writes one thread's buffer as a new run, then empties it
+        void spill(unsigned int tId);
+
+        // Most spilled runs one merge reads, so that their windows and the output batch fit a quarter of memoryBytes
+        size_t getMaxFanIn() const;
+
+        // Entries of each read window in a merge of runCount spilled runs
+        size_t getWindowEntries(size_t runCount) const;
+
+        // Merges the runs in passes of getMaxFanIn() runs each, until they are few enough for one merge
+        void reduceRuns();
+
+        // K-way merges group (and the sorted thread buffers, if withBuffers is set) and calls consume(ids, count) on
+        // batches of at most batchEntries ascending, distinct IDs. Returns the number of distinct IDs
+        size_t mergeRuns(const std::vector<Run>& group, bool withBuffers, size_t batchEntries,
+                         const std::function<void(const uint64_t*, size_t)>& consume);
+
+        // Writes or reads bytes at offset of the spill file. Return false on failure
+        bool writeAt(uint64_t offset, const void* data, size_t bytes);
+        bool readAt(uint64_t offset, void* data, size_t bytes) const;
+
+};
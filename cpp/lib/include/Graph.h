@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 class Graph {
@@ -29,6 +30,10 @@ class Graph {
         // Returns true if an edge exists between the two passed nodes
         bool getEdge(int node1, int node2) const;
 
+        // Renames every node in place: node i of the result is node newToOld[i] of the current graph
+        // newToOld must be a permutation of [0, nodeCount)
+        void relabel(const int* newToOld);
+
         // Returns the total memory footprint of the graph in bytes
         size_t getMemoryFootprint() const;
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class NumaTopology {
+
+    /*
+        The machine's NUMA nodes and the CPUs on each, plus the few memory policy calls the solvers need
+        Read from /sys/devices/system/node on Linux, and the policies go straight through the mbind / move_pages
+        syscalls, so nothing has to link libnuma. Anywhere else (or on a kernel without NUMA) it is a single node
+        holding every core, and the policy calls are no-ops that return false
+
+        Only nodes with CPUs are listed. Node indices below are dense (0 .. nodeCount - 1), and nodeIds maps them to
+        the kernel's IDs, which may have gaps
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        int nodeCount;
+        std::vector<int> nodeIds;
+
+        // CPUs of each node, in ascending order
+        std::vector<std::vector<int>> nodeCpus;
+
+        // Constructors
+        NumaTopology() : nodeCount(0) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Reads the topology of the running machine
+        void constructFrom();
+
+        // Spreads the pages of [address, address + bytes) round robin over every node as they are first touched
+        // Only whole pages inside the range are affected. Returns false if the policy could not be set
+        bool interleave(void* address, size_t bytes) const;
+
+        // Places the pages of [address, address + bytes) on one node (preferred, so a full node spills elsewhere)
+        bool preferNode(void* address, size_t bytes, int node) const;
+
+        // Adds the resident bytes of [address, address + bytes) per node to bytesPerNode (resized to nodeCount)
+        // Pages not yet touched (or on a memory-only node) go to untouchedBytes instead. Returns false if the kernel could not be asked
+        bool countResidentBytes(const void* address, size_t bytes, std::vector<uint64_t>* bytesPerNode,
+                                uint64_t* untouchedBytes) const;
+
+        // Returns the CPU thread t of numThreads should run on: threads are spread over the nodes in contiguous runs
+        // (the first numThreads / nodeCount on node 0, and so on), and round robin over the CPUs of their node
+        int getCpuForThread(unsigned int t, unsigned int numThreads) const;
+
+        // Returns the node the contiguous run of thread t falls on, as in getCpuForThread
+        int getNodeForThread(unsigned int t, unsigned int numThreads) const;
+
+    private:
+
+        /*   Instance Functions   */
+
+        // Sets a memory policy on the whole pages of [address, address + bytes). Returns false on failure
+        bool setPolicy(void* address, size_t bytes, int mode, const std::vector<int>& nodes) const;
+
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "AdjacencyList.h"
+#include "Allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+class PackedStateStore {
+
+    /*
+        Sub-byte game state table for the frontier solvers, safe to update from any number of threads
+        Two planes of 64-bit words:
+            - Cop turn wins, one bit per state, set with fetch_or
+            - Robber safe moves, counterBits per state (just enough for maxDegree + 1), counted down with a CAS on the word
+        A robber turn win is a counter of zero, so it needs no plane of its own
+        Counters never straddle two words, so a word holds 64 / counterBits of them and any spare top bits stay zero
+
+        The ...Owned variants swap the read-modify-write for a plain load and store, for owner-computes solvers where
+        each thread is the only writer of a range of states cut at getOwnershipGranularity()
+
+        Counterless mode swaps the counters for a plane of robber turn win bits (2 bits per state in total)
+        The solver then re-checks a robber state's closed neighbourhood of cop turn wins instead of counting down
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t numStates;
+        bool counterless;
+        int counterBits;
+        int countersPerWord;
+
+        // Constructors
+        PackedStateStore() : numStates(0), counterless(false), counterBits(0), countersPerWord(0), counterMask(0),
+                             copTurnWins(nullptr), safeMoves(nullptr), robberTurnWins(nullptr),
+                             copWordCount(0), counterWordCount(0) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Both planes are requested from mem and allocated right away, with every bit clear
+        // maxSafeMoves is the largest counter value ever stored (maxDegree + 1, the robber may also stay put)
+        // placement decides which NUMA nodes the planes live on (see Allocator::Placement)
+        void constructFrom(size_t numStates, int maxSafeMoves, Allocator* mem, bool counterless = false,
+                           Allocator::Placement placement = Allocator::Placement::FIRST_TOUCH);
+
+        // Marks a capture, which is won for the cops whoever moves next. Safe from any number of threads
+        inline void markCapture(size_t state) {
+            this->markCopTurnWin(state);
+            if (this->counterless) this->markRobberTurnWin(state);
+        }
+
+        // Sets the cop turn win bit of state. Returns true if this call set it, so exactly one thread queues the state
+        inline bool markCopTurnWin(size_t state) {
+            uint64_t bit = (uint64_t)1 << (state & 63);
+            return (this->copTurnWins[state >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+        }
+
+        inline bool isCopTurnWin(size_t state) const {
+            return (this->copTurnWins[state >> 6].load(std::memory_order_relaxed) >> (state & 63)) & 1;
+        }
+
+        // Initial counter of state. Not atomic against other writers of the same word, so only for single threaded setup
+        // Ignored in counterless mode
+        inline void setSafeMoves(size_t state, int count) {
+            if (this->counterless) return;
+            size_t word = state / this->countersPerWord;
+            int shift = static_cast<int>(state % this->countersPerWord) * this->counterBits;
+            uint64_t value = this->safeMoves[word].load(std::memory_order_relaxed);
+            value = (value & ~(this->counterMask << shift)) | (static_cast<uint64_t>(count) << shift);
+            this->safeMoves[word].store(value, std::memory_order_relaxed);
+        }
+
+        // Overwrites the counter of state with count. Safe against other threads updating the rest of the word
+        // Ignored in counterless mode
+        inline void resetSafeMoves(size_t state, int count) {
+            if (this->counterless) return;
+            size_t word = state / this->countersPerWord;
+            int shift = static_cast<int>(state % this->countersPerWord) * this->counterBits;
+            std::atomic<uint64_t>& target = this->safeMoves[word];
+
+            uint64_t oldValue = target.load(std::memory_order_relaxed);
+            if (((oldValue >> shift) & this->counterMask) == static_cast<uint64_t>(count)) return;
+            uint64_t newValue;
+            do {
+                newValue = (oldValue & ~(this->counterMask << shift)) | (static_cast<uint64_t>(count) << shift);
+            } while (!target.compare_exchange_weak(oldValue, newValue, std::memory_order_relaxed));
+        }
+
+        // Takes one safe move away from state. Returns true if this call took the last one (the robber turn is now a win)
+        // A counter already at zero (a capture, or a state the robber has already lost) is left alone, since borrowing
+        // would corrupt the neighbouring counter
+        inline bool decrementSafeMoves(size_t state) {
+            size_t word = state / this->countersPerWord;
+            int shift = static_cast<int>(state % this->countersPerWord) * this->counterBits;
+            std::atomic<uint64_t>& target = this->safeMoves[word];
+
+            uint64_t oldValue = target.load(std::memory_order_relaxed);
+            while (true) {
+                uint64_t count = (oldValue >> shift) & this->counterMask;
+                if (count == 0) return false;
+                if (target.compare_exchange_weak(oldValue, oldValue - ((uint64_t)1 << shift), std::memory_order_relaxed)) {
+                    return count == 1;
+                }
+            }
+        }
+
+        // Owner-computes variants of the three updates above and below. Plain load and store, so the caller must be the
+        // only thread touching the word right now (its range of states is cut at getOwnershipGranularity())
+        inline bool markCopTurnWinOwned(size_t state) {
+            uint64_t bit = (uint64_t)1 << (state & 63);
+            std::atomic<uint64_t>& word = this->copTurnWins[state >> 6];
+            uint64_t value = word.load(std::memory_order_relaxed);
+            if (value & bit) return false;
+            word.store(value | bit, std::memory_order_relaxed);
+            return true;
+        }
+
+        inline bool decrementSafeMovesOwned(size_t state) {
+            size_t word = state / this->countersPerWord;
+            int shift = static_cast<int>(state % this->countersPerWord) * this->counterBits;
+            std::atomic<uint64_t>& target = this->safeMoves[word];
+
+            uint64_t value = target.load(std::memory_order_relaxed);
+            uint64_t count = (value >> shift) & this->counterMask;
+            if (count == 0) return false;
+            target.store(value - ((uint64_t)1 << shift), std::memory_order_relaxed);
+            return count == 1;
+        }
+
+        inline bool markRobberTurnWinOwned(size_t state) {
+            uint64_t bit = (uint64_t)1 << (state & 63);
+            std::atomic<uint64_t>& word = this->robberTurnWins[state >> 6];
+            uint64_t value = word.load(std::memory_order_relaxed);
+            if (value & bit) return false;
+            word.store(value | bit, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Returns the smallest run of states that always covers whole words of every plane
+        // Ranges that start and end on multiples of it never share a word
+        inline size_t getOwnershipGranularity() const {
+            if (this->counterless) return 64;
+            return std::lcm(static_cast<size_t>(64), static_cast<size_t>(this->countersPerWord));
+        }
+
+        // Sets the robber turn win bit of state (counterless mode only). Returns true if this call set it
+        inline bool markRobberTurnWin(size_t state) {
+            uint64_t bit = (uint64_t)1 << (state & 63);
+            return (this->robberTurnWins[state >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+        }
+
+        inline bool isRobberTurnWin(size_t state) const {
+            if (this->counterless) {
+                return (this->robberTurnWins[state >> 6].load(std::memory_order_relaxed) >> (state & 63)) & 1;
+            }
+            size_t word = state / this->countersPerWord;
+            int shift = static_cast<int>(state % this->countersPerWord) * this->counterBits;
+            return ((this->safeMoves[word].load(std::memory_order_relaxed) >> shift) & this->counterMask) == 0;
+        }
+
+        // Counterless mode: returns true if the robber at r has no escape left against the cop config whose states
+        // start at stateBase (cId * N), i.e. staying and every neighbour are all cop turn wins
+        // Only complete once the wave that set the last of those bits has finished, which is why every solver re-checks
+        // from the state that was won last
+        inline bool isRobberTrapped(size_t stateBase, int r, const AdjacencyList& adj) const {
+            if (!this->isCopTurnWin(stateBase + r)) return false;
+            uint8_t* edges = adj.getEdges(r);
+            for (int eIdx = 0; edges[eIdx] != 255; ++eIdx) {
+                if (!this->isCopTurnWin(stateBase + edges[eIdx])) return false;
+            }
+            return true;
+        }
+
+        // Returns the bits spent per state across both planes
+        inline double getBitsPerState() const {
+            return 1.0 + 64.0 / this->countersPerWord;
+        }
+
+        // Returns the total memory footprint of both planes in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        uint64_t counterMask;
+
+        std::atomic<uint64_t>* copTurnWins;
+        std::atomic<uint64_t>* safeMoves;
+        std::atomic<uint64_t>* robberTurnWins;
+
+        size_t copWordCount;
+        size_t counterWordCount;
+
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "AdjacencyList.h"
+
+#include <cstdint>
+
+// Node IDs are uint8_t with 255 reserved as the edge terminator, so 4 words always cover the graph
+constexpr int ROBBER_SET_WORDS = 4;
+
+struct RobberSet {
+
+    /*
+        Fixed-size bitset over robber positions (bit r set <=> node r is in the set)
+        Lets a solver evaluate every robber position of one cop configuration with a handful of word operations
+    */
+
+    uint64_t words[ROBBER_SET_WORDS];
+
+    inline void clear() {
+        for (int i = 0; i < ROBBER_SET_WORDS; ++i) this->words[i] = 0;
+    }
+
+    inline void set(int node) {
+        this->words[node >> 6] |= (uint64_t)1 << (node & 63);
+    }
+
+    inline bool test(int node) const {
+        return (this->words[node >> 6] >> (node & 63)) & 1;
+    }
+
+    inline RobberSet& operator|=(const RobberSet& other) {
+        for (int i = 0; i < ROBBER_SET_WORDS; ++i) this->words[i] |= other.words[i];
+        return *this;
+    }
+
+    inline bool operator==(const RobberSet& other) const {
+        for (int i = 0; i < ROBBER_SET_WORDS; ++i) {
+            if (this->words[i] != other.words[i]) return false;
+        }
+        return true;
+    }
+
+    // Returns the nodes in 'universe' that are not in this set
+    inline RobberSet complementWithin(const RobberSet& universe) const {
+        RobberSet out;
+        for (int i = 0; i < ROBBER_SET_WORDS; ++i) out.words[i] = universe.words[i] & ~this->words[i];
+        return out;
+    }
+
+    // Returns the number of nodes in the set
+    inline int count() const {
+        int total = 0;
+        for (int i = 0; i < ROBBER_SET_WORDS; ++i) total += __builtin_popcountll(this->words[i]);
+        return total;
+    }
+
+    // Returns the set {0, 1, ..., N-1}
+    static inline RobberSet full(int N) {
+        RobberSet out;
+        out.clear();
+        for (int node = 0; node < N; ++node) out.set(node);
+        return out;
+    }
+
+    // Returns the closed neighbourhood of node (the node itself plus every adjacent node)
+    static inline RobberSet closedNeighbourhood(const AdjacencyList& adj, int node) {
+        RobberSet out;
+        out.clear();
+        out.set(node);
+        const uint8_t* edges = adj.getEdges(node);
+        for (int eIdx = 0; edges[eIdx] != 255; eIdx++) {
+            out.set(edges[eIdx]);
+        }
+        return out;
+    }
+
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+    State layout policies for AuxGraph
+    Each one maps a (cop config ID, robber position) pair to a slot of the flat state table, and back
+    They trade which of the two moves stays local:
+        - ConfigMajorLayout: cId * N + r. Robber moves stay inside one config's N states, team moves stride by N
+        - RobberMajorLayout: r * configCount + cId. Team moves stay inside one robber's row, robber moves stride by configCount
+        - BlockedLayout: tiles of B configs x N robbers, each stored robber-major. Robber moves stride by B inside a tile,
+          and team moves into nearby configs share the tile's lines
+    constructFrom() is called by AuxGraph once the config count is known. numStates may exceed configCount * N
+    (BlockedLayout pads the last tile), and the padding slots are never touched
+*/
+
+class ConfigMajorLayout {
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t configCount;
+        int N;
+        size_t numStates;
+
+        // Constructors
+        ConfigMajorLayout() : configCount(0), N(0), numStates(0) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor
+        inline void constructFrom(size_t configCount, int N) {
+            this->configCount = configCount;
+            this->N = N;
+            this->numStates = configCount * N;
+        }
+
+        inline size_t getStateId(size_t cId, int r) const {
+            return cId * this->N + r;
+        }
+
+        inline void splitStateId(size_t stateId, size_t* cId, int* r) const {
+            *cId = stateId / this->N;
+            *r = static_cast<int>(stateId % this->N);
+        }
+
+        inline const char* getName() const {
+            return "config-major";
+        }
+
+};
+
+class RobberMajorLayout {
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t configCount;
+        int N;
+        size_t numStates;
+
+        // Constructors
+        RobberMajorLayout() : configCount(0), N(0), numStates(0) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor
+        inline void constructFrom(size_t configCount, int N) {
+            this->configCount = configCount;
+            this->N = N;
+            this->numStates = configCount * N;
+        }
+
+        inline size_t getStateId(size_t cId, int r) const {
+            return static_cast<size_t>(r) * this->configCount + cId;
+        }
+
+        inline void splitStateId(size_t stateId, size_t* cId, int* r) const {
+            *r = static_cast<int>(stateId / this->configCount);
+            *cId = stateId % this->configCount;
+        }
+
+        inline const char* getName() const {
+            return "robber-major";
+        }
+
+};
+
+class BlockedLayout {
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t configCount;
+        int N;
+        size_t numStates;
+
+        // Configs per tile. Must be a power of two, and has to be set before constructFrom()
+        size_t blockConfigs;
+
+        // Constructors
+        BlockedLayout() : configCount(0), N(0), numStates(0), blockConfigs(64), blockShift(6), blockMask(63) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. A blockConfigs that is not a power of two is rounded down to one
+        inline void constructFrom(size_t configCount, int N) {
+            this->blockShift = 0;
+            while (((size_t)2 << this->blockShift) <= this->blockConfigs) this->blockShift++;
+            this->blockConfigs = (size_t)1 << this->blockShift;
+            this->blockMask = this->blockConfigs - 1;
+
+            this->configCount = configCount;
+            this->N = N;
+            size_t blockCount = (configCount + this->blockMask) >> this->blockShift;
+            this->numStates = blockCount * this->blockConfigs * N;
+        }
+
+        inline size_t getStateId(size_t cId, int r) const {
+            return (((cId >> this->blockShift) * this->N + r) << this->blockShift) | (cId & this->blockMask);
+        }
+
+        inline void splitStateId(size_t stateId, size_t* cId, int* r) const {
+            size_t tileRow = stateId >> this->blockShift;
+            *r = static_cast<int>(tileRow % this->N);
+            *cId = ((tileRow / this->N) << this->blockShift) | (stateId & this->blockMask);
+        }
+
+        inline const char* getName() const {
+            return "blocked";
+        }
+
+    private:
+
+        /*   Instance Variables   */
+
+        int blockShift;
+        size_t blockMask;
+
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "NumaTopology.h"
+
+class SpinBarrier {
+
+    /*
+        Reusable barrier for a fixed number of threads
+        The last thread to arrive bumps a generation counter, the others spin on it (yielding after a while, so an
+        oversubscribed machine still makes progress). No syscalls unless a thread has to yield
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        unsigned int participants;
+
+        // Constructors
+        SpinBarrier() : participants(0), arrived(0), generation(0) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor
+        void constructFrom(unsigned int participants);
+
+        // Blocks until all participants have arrived, then releases them together
+        void arriveAndWait();
+
+    private:
+
+        /*   Instance Variables   */
+
+        std::atomic<unsigned int> arrived;
+        std::atomic<unsigned int> generation;
+
+};
+
+
+class ThreadPool {
+
+    /*
+        Persistent worker threads shared by every parallel phase of a solver (transition build, capture init, waves)
+        Threads are created once and park between jobs, so a job costs a wake-up and a SpinBarrier rather than
+        creating and joining one thread per core. The calling thread takes part in every job as thread 0
+
+        parallelFor splits a range into chunks and deals every thread a contiguous run of them, kept as a
+        work-stealing range (one packed atomic word). The owner takes chunks off the front, and a thread that
+        runs dry steals the back half of another thread's run
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        unsigned int numThreads;
+        bool pinned;
+
+        // Constructors
+        ThreadPool() : numThreads(0), pinned(false), stopping(false), jobGeneration(0), job(nullptr), ranges(nullptr) {}
+
+        // Destructor stops and joins the workers
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. numThreads of 0 means one per core. pinCores pins every thread to a core (where
+        // supported), spread over the NUMA nodes in contiguous runs: the first numThreads / nodeCount threads on node 0,
+        // and so on. Thread t's share of a range split evenly over the threads is then local to memory placed with
+        // Allocator::Placement::PARTITIONED. On a single node machine thread t lands on core t
+        void constructFrom(unsigned int numThreads, bool pinCores = false);
+
+        // Runs body(tId) once on every thread and returns when all of them are done
+        void run(const std::function<void(unsigned int)>& body);
+
+        // Runs body(tId, begin, end) over [0, count) in chunks of grain items, load balanced by work stealing
+        // Returns when every chunk is done
+        template <typename Body>
+        void parallelFor(size_t count, size_t grain, Body&& body) {
+
+            if (count == 0) return;
+            if (grain == 0) grain = 1;
+
+            // Chunk indices live in 32-bit halves of the range words
+            const size_t MAX_CHUNKS = (size_t)1 << 31;
+            if ((count + grain - 1) / grain > MAX_CHUNKS) grain = (count + MAX_CHUNKS - 1) / MAX_CHUNKS;
+            size_t chunkCount = (count + grain - 1) / grain;
+
+            for (unsigned int t = 0; t < this->numThreads; ++t) {
+                uint64_t lo = (chunkCount * t) / this->numThreads;
+                uint64_t hi = (chunkCount * (t + 1)) / this->numThreads;
+                this->ranges[t].bounds.store(lo | (hi << 32), std::memory_order_relaxed);
+            }
+
+            this->run([&](unsigned int tId) {
+                size_t chunk;
+                while (this->takeChunk(tId, &chunk)) {
+                    size_t begin = chunk * grain;
+                    size_t end = (begin + grain < count) ? begin + grain : count;
+                    body(tId, begin, end);
+                }
+            });
+
+            return;
+
+        }
+
+        // Returns the thread count a request resolves to (0 = one per core, never less than 1)
+        static unsigned int resolveThreadCount(unsigned int requested);
+
+        // Returns the number of NUMA nodes the pinned threads are spread over (1 if the pool is not pinned)
+        int getNodeCount() const;
+
+    private:
+
+        // One thread's remaining chunks [lo, hi), packed as lo | hi << 32, on its own cache line
+        struct alignas(64) StealRange {
+            std::atomic<uint64_t> bounds;
+        };
+
+        /*   Instance Variables   */
+
+        std::vector<std::thread> workers;
+        SpinBarrier done;
+
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        bool stopping;
+
+        std::atomic<uint64_t> jobGeneration;
+        const std::function<void(unsigned int)>* job;
+
+        StealRange* ranges;
+
+        // Machine topology, and the core each thread is pinned to (only filled in if pinned)
+        NumaTopology topology;
+        std::vector<int> threadCores;
+
+
+        /*   Instance Functions   */
+
+        // Body of every worker thread: wait for a job, run it, meet at the barrier, repeat
+        void workerLoop(unsigned int tId);
+
+        // Takes the next chunk from tId's own range, stealing half of another range once it is empty
+        // Returns false once there is nothing left anywhere
+        bool takeChunk(unsigned int tId, size_t* chunk);
+
+        // Pins the calling thread to core (no-op where unsupported)
+        static void pinToCore(unsigned int core);
+
+};
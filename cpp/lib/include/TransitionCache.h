@@ -0,0 +1,109 @@
+#pragma once
+
+#include "AdjacencyList.h"
+#include "Allocator.h"
+#include "CompressedTransitions.h"
+#include "ThreadPool.h"
+#include "copconfig.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class TransitionCache {
+
+    /*
+        The cop configs and their CompressedTransitions table for one (graph, k) pair, persisted to disk
+        The table only depends on the graph and k, so it is built once and every later run memory maps the file
+        read-only. Loading is near-instant, and concurrent solver processes share the same page cache
+        Nothing is written unless a file is given: the solvers only keep one when run with --transition-cache
+
+        File layout (every section starts on an 8 byte boundary):
+            Header | configs (configCount * k bytes) | row heads ((configCount + 1) * 8 bytes) | encoded rows
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        int k;
+        int N;
+        size_t configCount;
+
+        // Sorted cop configs in rank order (configCount * k bytes)
+        const uint8_t* configs;
+
+        // Team moves of every config, as plain config IDs
+        CompressedTransitions transitions;
+
+        // True if the table came from an existing cache file rather than being built this run
+        bool loadedFromDisk;
+
+        // Constructors
+        TransitionCache() : k(0), N(0), configCount(0), configs(nullptr), loadedFromDisk(false),
+                            ownedConfigs(nullptr), ownedHeads(nullptr), ownedData(nullptr),
+                            mappedBase(nullptr), mappedBytes(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+        // Destructor
+        ~TransitionCache();
+
+        TransitionCache(const TransitionCache&) = delete;
+        TransitionCache& operator=(const TransitionCache&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Maps fileName if it holds the table for this graph and k, otherwise builds the table on pool (a temporary pool
+        // with one thread per core if nullptr) and writes it to fileName (creating its directory) for the next run
+        // fileName may be nullptr or empty to skip the disk entirely
+        // A built table lives in arenas from mem when one is given (so it shows up in its report), otherwise on the heap
+        // Returns false if the table could not be built (a failed write only prints a warning)
+        bool constructFrom(const AdjacencyList* adj, const CopConfigRanker* ranker, const char* fileName,
+                           Allocator* mem = nullptr, ThreadPool* pool = nullptr);
+
+        // Returns the conventional cache file for a graph file and k inside cacheDir ("<cacheDir>/<graph name>.k<k>.transitions")
+        // or an empty string (no disk cache) if cacheDir is nullptr
+        static std::string getDefaultPath(const char* cacheDir, const std::string& graphFile, int k);
+
+        // Returns the bytes of table memory on the heap (0 for a mapped file, or a table built into an Allocator)
+        size_t getMemoryFootprint() const;
+
+        // Returns the size of the mapped cache file in bytes (0 if the table was built this run)
+        inline size_t getMappedBytes() const {
+            return this->mappedBytes;
+        }
+
+    private:
+
+        /*   Instance Variables   */
+
+        // Heap storage of a table built without an Allocator
+        uint8_t* ownedConfigs;
+        size_t* ownedHeads;
+        uint8_t* ownedData;
+
+        void* mappedBase;
+        size_t mappedBytes;
+
+        // Platform handles kept open for the lifetime of the mapping (unused on POSIX)
+        void* fileHandle;
+        void* mappingHandle;
+
+
+        /*   Instance Functions   */
+
+        // Maps fileName and validates its header. Returns false (leaving nothing mapped) on any mismatch
+        bool mapFile(const char* fileName, uint64_t graphHash);
+
+        // Releases the mapping, if any
+        void unmapFile();
+
+        // Generates the configs and the transition rows in two parallel passes: one sizes every encoded row,
+        // a prefix sum places them, and the second encodes each row straight into its final slot.
+        // Every row is generated twice, but peak memory is exactly the final table
+        void build(const AdjacencyList* adj, const CopConfigRanker* ranker, ThreadPool& pool, Allocator* mem);
+
+        // Writes the current table to fileName (through a temporary file, so readers never map a partial file)
+        bool writeFile(const char* fileName, uint64_t graphHash) const;
+
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AdjacencyList.h"
+#include "CompressedTransitions.h"
+#include "CopKernels.h"
+#include "ThreadPool.h"
+#include "copconfig.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+class TransitionProvider {
+
+    /*
+        Source of cop team moves under a memory budget
+        The rows with the largest Cartesian products (the most expensive to generate) are precomputed into a
+        CompressedTransitions table until the budget is spent. Every other row is generated on the fly
+        A budget of 0 behaves like a fully on-the-fly solver, and a large enough budget like a fully precomputed one
+        Read-only once constructed, so any number of threads may query it at once
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        int k;
+        int N;
+        size_t configCount;
+
+        size_t budgetBytes;
+        size_t cachedRows;
+        size_t cachedEdges;
+
+        // Constructors
+        TransitionProvider() : k(0), N(0), configCount(0), budgetBytes(0), cachedRows(0), cachedEdges(0),
+                               adj(nullptr), ranker(nullptr) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. adj and ranker must outlive this object. The rows are sized and encoded on pool
+        void constructFrom(const AdjacencyList* adj, const CopConfigRanker* ranker, size_t budgetBytes, ThreadPool& pool);
+
+        // Calls visit(nextId) for every team move out of config cId
+        // Rows are visited in ascending order without duplicates, cached or generated. The one exception is a row
+        // generated by the generic kernel (K == 0, see CopKernels.h), which comes in odometer order and may repeat an ID
+        template <int K = 0, typename Visitor>
+        inline void forEachMove(size_t cId, Visitor&& visit) const {
+
+            if (!this->rowIndex.empty() && this->rowIndex[cId] != NOT_CACHED) {
+                this->rows.forEachInRow(this->rowIndex[cId], visit);
+                return;
+            }
+
+            uint8_t currentCops[CopKernel<K>::CAPACITY];
+            this->ranker->unrank(cId, currentCops);
+            CopKernel<K>::forEachTeamMove(currentCops, this->k, *this->adj, *this->ranker, visit);
+
+            return;
+
+        }
+
+        // Returns the total memory footprint of the cache in bytes (never more than budgetBytes: the rows are sized
+        // before they are encoded, and stored at exactly that size)
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        static constexpr uint32_t NOT_CACHED = UINT32_MAX;
+
+        /*   Instance Variables   */
+
+        const AdjacencyList* adj;
+        const CopConfigRanker* ranker;
+
+        // rowIndex[cId] is the row of cId within rows, or NOT_CACHED. Empty when nothing fits the budget
+        std::vector<uint32_t> rowIndex;
+
+        // Heads and encoded rows, written in place by the parallel encode and viewed through rows
+        std::vector<size_t> rowHeads;
+        std::vector<uint8_t> rowData;
+        CompressedTransitions rows;
+
+};
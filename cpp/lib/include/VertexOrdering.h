@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Graph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class VertexOrdering {
+
+    /*
+        Optional relabelling of a graph's nodes, applied between Graph and AdjacencyList
+        Node IDs otherwise come straight from the row order of the matrix file, so a robber move (cId * N + r) or a
+        cop moving one slot of a config can jump anywhere in the state table. Both orders below give neighbours
+        nearby labels (a small bandwidth), which keeps robber moves inside a few cache lines and, since the
+        lexicographic config order varies the last slot fastest, keeps a team move's target configs close together
+            - BFS: breadth-first order from a pseudo-peripheral node, per connected component
+            - RCM: reverse Cuthill-McKee, the same but with each node's neighbours queued by ascending degree and
+              the whole order reversed
+        The solvers work on the relabelled graph throughout and map every node they print back with toOriginal()
+    */
+
+    public:
+
+        enum class Method { ORIGINAL, BFS, RCM };
+
+        /*   Instance Variables   */
+
+        int nodeCount;
+        Method method;
+
+        // Largest |label(u) - label(v)| over the edges, under the file's labels and under the new ones
+        int bandwidthBefore;
+        int bandwidthAfter;
+
+        // Constructors
+        VertexOrdering() : nodeCount(0), method(Method::ORIGINAL), bandwidthBefore(0), bandwidthAfter(0),
+                           newToOld(nullptr), oldToNew(nullptr) {}
+
+        // Destructor
+        ~VertexOrdering();
+
+        VertexOrdering(const VertexOrdering&) = delete;
+        VertexOrdering& operator=(const VertexOrdering&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Computes the order for g without touching it (ORIGINAL is the identity)
+        void constructFrom(const Graph* g, Method method);
+
+        // Relabels g in place, node v of the file becoming node toRelabelled(v)
+        void apply(Graph* g) const;
+
+        // Returns the file's label of a relabelled node, and the other way around
+        inline int toOriginal(int node) const {
+            return this->newToOld[node];
+        }
+
+        inline int toRelabelled(int node) const {
+            return this->oldToNew[node];
+        }
+
+        // Writes the config (length k, relabelled nodes) into outConfig in the file's labels, sorted again
+        void configToOriginal(const uint8_t* config, int k, uint8_t* outConfig) const;
+
+        // Returns a suffix that keeps the on-disk caches of different orders of one graph apart ("" for ORIGINAL)
+        std::string getCacheSuffix() const;
+
+        // Returns the lowercase name of the method ("original", "bfs" or "rcm")
+        const char* getMethodName() const;
+
+        // Parses a method name as given on the command line. Returns false if it is not one
+        static bool parseMethod(const std::string& name, Method* outMethod);
+
+        // Returns the total memory footprint of both maps in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        int* newToOld;
+        int* oldToNew;
+
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Allocator.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class WaveFrontier {
+
+    /*
+        Double-buffered frontier for the level-synchronous solvers
+        Workers push the next wave straight into a dense bitmap (a Cop turn plane followed by a Robber turn plane),
+        so there are no per-thread vectors to merge. advance() then counts the wave and keeps whichever form is smaller:
+            - The bitmap itself, 2 bits per state of the whole state space
+            - A list of 32-bit entries (stateId << 1 | robberTurn) in bitmap order, compacted into the other buffer
+        A list is only kept while it fits in one bitmap, so both buffers together cost a flat 4 bits per state
+        State spaces past 2^31 states always stay dense
+
+        Either form is walked in blocks of 64 states, a block's Cop turns and then its Robber turns, since the
+        work for both turns of nearby states lands on the same words of the state table
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        size_t numStates;
+
+        // Number of states in the current wave (robberTurnSize of them on the Robber's turn), and the form it is stored in
+        size_t waveSize;
+        size_t robberTurnSize;
+        bool dense;
+
+        // Constructors
+        WaveFrontier() : numStates(0), waveSize(0), robberTurnSize(0), dense(false), planeWords(0), listAllowed(false),
+                         current(nullptr), next(nullptr) {}
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. Both buffers are requested from mem and allocated right away, starting out empty
+        // placement decides which NUMA nodes the buffers live on (see Allocator::Placement), PARTITIONED interleaves
+        void constructFrom(size_t numStates, Allocator* mem, Allocator::Placement placement = Allocator::Placement::FIRST_TOUCH);
+
+        // Adds a state to the next wave. Safe from any number of threads
+        // The caller must push each (state, turn) at most once per wave, which the state table's win bits already ensure
+        inline void push(size_t state, bool robberTurn) {
+            size_t word = (robberTurn ? this->planeWords : 0) + (state >> 6);
+            this->next[word].fetch_or((uint64_t)1 << (state & 63), std::memory_order_relaxed);
+        }
+
+        // push() for a thread that is the only writer of the state's 64-state block right now (owner-computes mode)
+        inline void pushOwned(size_t state, bool robberTurn) {
+            size_t word = (robberTurn ? this->planeWords : 0) + (state >> 6);
+            uint64_t value = this->next[word].load(std::memory_order_relaxed);
+            this->next[word].store(value | ((uint64_t)1 << (state & 63)), std::memory_order_relaxed);
+        }
+
+        // Returns true if (state, turn) has been pushed to the next wave
+        inline bool isPushed(size_t state, bool robberTurn) const {
+            size_t word = (robberTurn ? this->planeWords : 0) + (state >> 6);
+            return (this->next[word].load(std::memory_order_relaxed) >> (state & 63)) & 1;
+        }
+
+        // Makes everything pushed so far the current wave, in whichever form is smaller, and starts an empty next wave
+        // Must only be called between waves, once every batch of the previous wave has been visited
+        // Returns the size of the new wave
+        size_t advance(ThreadPool& pool);
+
+        // Drops the current wave without visiting it, for a wave that was solved some other way
+        void discard();
+
+        // Returns which buffer holds the current wave, 0 for A and 1 for B. Between waves, the buffers' contents plus
+        // this, waveSize, robberTurnSize and dense are the whole frontier (what a checkpoint saves)
+        int getCurrentBuffer() const;
+
+        // Puts back a frontier saved between waves. The contents of both buffers must already be back in place
+        void restore(size_t waveSize, size_t robberTurnSize, bool dense, int currentBuffer);
+
+        // Returns the number of batches the current wave is handed out in
+        inline size_t getBatchCount() const {
+            if (this->dense) return (this->planeWords + DENSE_BATCH_BLOCKS - 1) / DENSE_BATCH_BLOCKS;
+            return (this->waveSize + LIST_BATCH_STATES - 1) / LIST_BATCH_STATES;
+        }
+
+        // Runs visit(state, robberTurn) for every state in one batch of the current wave
+        // A dense batch is cleared as it is read (that is what readies the buffer for reuse), so visit each batch exactly once
+        template <typename Visitor>
+        inline void forEachInBatch(size_t batch, Visitor&& visit) {
+
+            if (this->dense) {
+                size_t begin = batch * DENSE_BATCH_BLOCKS;
+                size_t end = begin + DENSE_BATCH_BLOCKS;
+                if (end > this->planeWords) end = this->planeWords;
+
+                for (size_t block = begin; block < end; ++block) {
+                    for (int turn = 0; turn < 2; ++turn) {
+                        std::atomic<uint64_t>& word = this->current[turn * this->planeWords + block];
+                        uint64_t bits = word.load(std::memory_order_relaxed);
+                        if (bits == 0) continue;
+                        word.store(0, std::memory_order_relaxed);
+
+                        while (bits != 0) {
+                            visit(block * 64 + __builtin_ctzll(bits), turn == 1);
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+            } else {
+                size_t begin = batch * LIST_BATCH_STATES;
+                size_t end = begin + LIST_BATCH_STATES;
+                if (end > this->waveSize) end = this->waveSize;
+
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t entry = static_cast<uint32_t>(this->current[i >> 1].load(std::memory_order_relaxed) >> ((i & 1) * 32));
+                    visit(static_cast<size_t>(entry >> 1), (entry & 1) != 0);
+                }
+            }
+
+            return;
+
+        }
+
+        // Runs visit(state, robberTurn) for every state of the current wave in [stateBegin, stateEnd), in the same order
+        // as the batches. Both bounds must be multiples of 64 (or stateEnd == numStates), and the ranges handed out
+        // in one wave must not overlap, since a dense range is cleared as it is read
+        template <typename Visitor>
+        inline void forEachInRange(size_t stateBegin, size_t stateEnd, Visitor&& visit) {
+
+            size_t blockBegin = stateBegin >> 6;
+            size_t blockEnd = (stateEnd + 63) >> 6;
+
+            if (this->dense) {
+                for (size_t block = blockBegin; block < blockEnd; ++block) {
+                    for (int turn = 0; turn < 2; ++turn) {
+                        std::atomic<uint64_t>& word = this->current[turn * this->planeWords + block];
+                        uint64_t bits = word.load(std::memory_order_relaxed);
+                        if (bits == 0) continue;
+                        word.store(0, std::memory_order_relaxed);
+
+                        while (bits != 0) {
+                            visit(block * 64 + __builtin_ctzll(bits), turn == 1);
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+            } else {
+                // The list is sorted by block, so the range is one run of it
+                auto blockAt = [&](size_t i) {
+                    uint32_t entry = static_cast<uint32_t>(this->current[i >> 1].load(std::memory_order_relaxed) >> ((i & 1) * 32));
+                    return static_cast<size_t>(entry >> 7);
+                };
+                auto lowerBound = [&](size_t block) {
+                    size_t lo = 0;
+                    size_t hi = this->waveSize;
+                    while (lo < hi) {
+                        size_t mid = lo + (hi - lo) / 2;
+                        if (blockAt(mid) < block) lo = mid + 1;
+                        else hi = mid;
+                    }
+                    return lo;
+                };
+
+                size_t end = lowerBound(blockEnd);
+                for (size_t i = lowerBound(blockBegin); i < end; ++i) {
+                    uint32_t entry = static_cast<uint32_t>(this->current[i >> 1].load(std::memory_order_relaxed) >> ((i & 1) * 32));
+                    visit(static_cast<size_t>(entry >> 1), (entry & 1) != 0);
+                }
+            }
+
+            return;
+
+        }
+
+        // Returns the total memory footprint of both buffers in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        static constexpr size_t DENSE_BATCH_BLOCKS = 64;
+        static constexpr size_t LIST_BATCH_STATES = 4096;
+
+        // Words in one plane (one per 64-state block). A buffer is two planes, and holds up to 4 * planeWords list entries
+        size_t planeWords;
+        bool listAllowed;
+
+        std::atomic<uint64_t>* current;
+        std::atomic<uint64_t>* next;
+
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class WorkStealingQueue {
+
+    /*
+        Lock-free deque of 64-bit work items with one owner thread (Chase-Lev, in the C11 form of Le et al.)
+        The owner pushes and pops at the bottom (newest first), every other thread steals from the top (oldest first)
+        Only the owner writes bottom and top only moves by CAS, so the one contended case is the last item,
+        which pop and steal settle with the same CAS on top
+
+        The ring doubles when it fills up. Outgrown rings are kept until the queue is destroyed, since a thief
+        may still be reading from one
+    */
+
+    public:
+
+        // Constructors
+        WorkStealingQueue() : top(0), bottom(0), ring(nullptr) {}
+
+        // Destructor frees every ring
+        ~WorkStealingQueue();
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor. initialCapacity is rounded up to a power of two
+        void constructFrom(size_t initialCapacity);
+
+        // Adds an item at the bottom. Owner thread only
+        inline void push(uint64_t item) {
+            int64_t b = this->bottom.load(std::memory_order_relaxed);
+            int64_t t = this->top.load(std::memory_order_acquire);
+            Ring* r = this->ring.load(std::memory_order_relaxed);
+
+            if (b - t >= r->capacity) r = this->grow(t, b);
+
+            r->slots[b & r->mask].store(item, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            this->bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // Takes the newest item. Owner thread only. Returns false if the queue is empty
+        inline bool pop(uint64_t* item) {
+            int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+            Ring* r = this->ring.load(std::memory_order_relaxed);
+            this->bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = this->top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                this->bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            *item = r->slots[b & r->mask].load(std::memory_order_relaxed);
+            if (t < b) return true;
+
+            // Last item, which a thief may be taking at the same time
+            bool won = this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            this->bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        // Takes the oldest item. Safe from any thread. Returns false if the queue is empty or another thread won the item
+        inline bool steal(uint64_t* item) {
+            int64_t t = this->top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = this->bottom.load(std::memory_order_acquire);
+            if (t >= b) return false;
+
+            Ring* r = this->ring.load(std::memory_order_acquire);
+            uint64_t value = r->slots[t & r->mask].load(std::memory_order_relaxed);
+            if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+
+            *item = value;
+            return true;
+        }
+
+        // Returns the bytes held by every ring, outgrown ones included (the queue's peak)
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        struct Ring {
+            int64_t capacity;
+            int64_t mask;
+            std::atomic<uint64_t>* slots;
+        };
+
+        /*   Instance Variables   */
+
+        // Thieves hammer top while the owner works on bottom, so each gets its own cache line
+        alignas(64) std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+        alignas(64) std::atomic<Ring*> ring;
+
+        // Every ring allocated so far, the current one last. Owner thread only
+        std::vector<Ring*> rings;
+
+
+        /*   Instance Functions   */
+
+        // Moves the items [t, b) into a ring twice the size and publishes it. Owner thread only
+        Ring* grow(int64_t t, int64_t b);
+
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Maximum supported number of cops to prevent stack overflow during generation
+constexpr size_t MAX_COPS = 256;
+
+// Calculates the exact state space size, allocates a precise contiguous array,
+// and iteratively generates all unique, sorted cop configurations in lexicographic order.
+// Returns nullptr (and writes 0 to outNumConfigs) if k is out of range
+uint8_t* generateCopConfigs(uint32_t k, int N, size_t* outNumConfigs);
+
+// Returns the number of sorted k-multisets over N nodes, C(N + k - 1, k)
+size_t countCopConfigs(int k, int N);
+
+// Advances a sorted config (length k) to the next config in lexicographic order, in place.
+// Returns false (leaving config untouched) if config was already the last one
+bool nextCopConfig(uint8_t* config, int k, int N);
+
+
+class CopConfigRanker {
+
+    /*
+        Combinatorial number system for sorted cop configurations (combinations with replacement)
+        Maps a sorted config to its index in the lexicographic order produced by generateCopConfigs, and back
+        Ranking costs exactly k table lookups, so the configs array is no longer needed to look up a config ID
+    */
+
+    public:
+
+        /*   Instance Variables   */
+
+        int k;
+        int N;
+        size_t configCount;
+
+        // Constructors
+        CopConfigRanker() : k(0), N(0), configCount(0), weights(nullptr), suffixCounts(nullptr) {}
+        CopConfigRanker(int k, int N);
+
+        // Destructor
+        ~CopConfigRanker();
+
+        CopConfigRanker(const CopConfigRanker&) = delete;
+        CopConfigRanker& operator=(const CopConfigRanker&) = delete;
+
+
+        /*   Instance Functions   */
+
+        // Deferred constructor
+        void constructFrom(int k, int N);
+
+        // Returns the config ID of a sorted config (config[0] <= config[1] <= ... <= config[k-1])
+        inline size_t rank(const uint8_t* config) const {
+            size_t id = this->configCount;
+            const size_t* w = this->weights;
+            for (int i = 0; i < this->k; ++i) {
+                id += w[config[i]];
+                w += this->N;
+            }
+            return id;
+        }
+
+        // rank() with the team size fixed at compile time, so the lookups unroll (K == 0 is plain rank())
+        template <int K>
+        inline size_t rank(const uint8_t* config) const {
+            if constexpr (K == 0) {
+                return this->rank(config);
+            } else {
+                size_t id = this->configCount;
+                for (int i = 0; i < K; ++i) {
+                    id += this->weights[i * this->N + config[i]];
+                }
+                return id;
+            }
+        }
+
+        // Returns the contribution of cop slot i sitting on node v to the rank
+        // rank(config) == configCount + sum of getWeight(i, config[i]), with unsigned wraparound
+        inline size_t getWeight(int i, uint8_t v) const {
+            return this->weights[i * this->N + v];
+        }
+
+        // Writes the sorted config with the given ID into outConfig (length k)
+        void unrank(size_t cId, uint8_t* outConfig) const;
+
+        // Returns the total memory footprint of the lookup tables in bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+
+        /*   Instance Variables   */
+
+        // weights[i * N + v] holds the (wrapping) rank contribution of slot i holding node v
+        size_t* weights;
+
+        // suffixCounts[j * (N + 1) + a] holds the number of sorted j-multisets drawn from nodes [a, N)
+        size_t* suffixCounts;
+
+};
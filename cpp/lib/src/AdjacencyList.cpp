@@ -10,9 +10,9 @@ AdjacencyList::AdjacencyList(Graph* g) {
 
 }
 
-AdjacencyList::AdjacencyList(int nodeCount, int maxDegree) : nodeCount(nodeCount), maxDegree(maxDegree) {
+AdjacencyList::AdjacencyList(int nodeCount, int maxDegree) : nodeCount(nodeCount), maxDegree(maxDegree), stride(maxDegree + 1) {
     
-    int totalSize = nodeCount * maxDegree;
+    int totalSize = nodeCount * stride;
     this->edges = new uint8_t[totalSize];
 
     // Initialize the entire memory block to 255 (terminator)
@@ -44,14 +44,15 @@ void AdjacencyList::constructFrom(Graph* g) {
         }
     }
 
-    // Step 2: Allocate memory and initialize terminators
-    int totalSize = nodeCount * maxDegree;
+    // Step 2: Allocate memory and initialize terminators (the extra slot per row guarantees a terminator)
+    stride = maxDegree + 1;
+    int totalSize = nodeCount * stride;
     edges = new uint8_t[totalSize];
     std::memset(edges, 255, totalSize);
 
     // Step 3: Populate the flat array directly
     for (int i = 0; i < nodeCount; ++i) {
-        int offset = i * maxDegree;
+        int offset = i * stride;
         int edgeIndex = 0;
         for (int j = 0; j < nodeCount; ++j) {
             if (g->getEdge(i, j)) {
@@ -66,12 +67,12 @@ void AdjacencyList::constructFrom(Graph* g) {
 }
 
 uint8_t* AdjacencyList::getEdges(int node) const {
-    return &(this->edges[node * maxDegree]);
+    return &(this->edges[node * stride]);
 }
 
 void AdjacencyList::addEdge(uint8_t u, uint8_t v) {
 
-    int offset = u * maxDegree;
+    int offset = u * stride;
     
     // Scan for the first open slot (marked by 255) and insert
     for (int i = 0; i < maxDegree; ++i) {
@@ -85,6 +86,32 @@ void AdjacencyList::addEdge(uint8_t u, uint8_t v) {
 
 }
 
+uint64_t AdjacencyList::getContentHash() const {
+
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+
+    auto mix = [&](uint8_t byte) {
+        hash ^= byte;
+        hash *= FNV_PRIME;
+    };
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        mix(static_cast<uint8_t>(this->nodeCount >> shift));
+    }
+
+    // Hash each row through its terminator, so the stride (and so maxDegree) does not affect the result
+    for (int node = 0; node < this->nodeCount; ++node) {
+        uint8_t* row = this->getEdges(node);
+        int i = 0;
+        while (row[i] != 255) mix(row[i++]);
+        mix(255);
+    }
+
+    return hash;
+
+}
+
 size_t AdjacencyList::getMemoryFootprint() const {
-    return sizeof(*this) + (this->nodeCount * this->maxDegree * sizeof(uint8_t));
+    return sizeof(*this) + (this->nodeCount * this->stride * sizeof(uint8_t));
 }
@@ -3,21 +3,207 @@
 #include <map>
 #include <algorithm>
 
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#include <iostream>
+
+// Size of a huge page on x86-64 and most aarch64 kernels. Arenas smaller than this stay on normal pages
+static constexpr size_t HUGE_PAGE_BYTES = (size_t)2 << 20;
+
+static size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
 Allocator::Allocator() {
     this->totalAllocatedBytes = 0;
     this->totalPendingBytes = 0;
     this->totalExternalBytes = 0;
+    this->hugePages = HugePages::TRANSPARENT;
+    this->topology.constructFrom();
 }
 
 Allocator::~Allocator() {
-    for (uint8_t* block : this->memoryBlocks) {
-        delete[] block;
+    for (const Arena& arena : this->memoryBlocks) {
+        if (arena.source == ArenaSource::HEAP) {
+            delete[] arena.base;
+            continue;
+        }
+#ifdef _WIN32
+        if (arena.source == ArenaSource::FILE) {
+            UnmapViewOfFile(arena.base);
+            CloseHandle(static_cast<HANDLE>(arena.mappingHandle));
+            CloseHandle(reinterpret_cast<HANDLE>(arena.fileHandle));
+        } else {
+            VirtualFree(arena.base, 0, MEM_RELEASE);
+        }
+#else
+        munmap(arena.base, arena.mappedBytes);
+        if (arena.source == ArenaSource::FILE) close(static_cast<int>(arena.fileHandle));
+#endif
+    }
+}
+
+void Allocator::setHugePages(HugePages mode) {
+    this->hugePages = mode;
+}
+
+void Allocator::setBackingDirectory(const std::string& directory) {
+    this->backingDirectory = directory;
+}
+
+bool Allocator::hasFileBackedArenas() const {
+    for (const Arena& arena : this->memoryBlocks) {
+        if (arena.source == ArenaSource::FILE) return true;
+    }
+    return false;
+}
+
+// Maps bytes of a fresh, already deleted file in directory into arena. Returns false (arena untouched) on failure
+static bool mapBackingFile(const std::string& directory, size_t bytes, uint8_t** outBase, size_t* outMappedBytes,
+                           intptr_t* outFileHandle, void** outMappingHandle) {
+
+#ifdef _WIN32
+    char fileName[MAX_PATH];
+    if (GetTempFileNameA(directory.c_str(), "cnr", 0, fileName) == 0) return false;
+
+    // Deleted when the last handle closes, and kept out of the cache manager's lazy writer where possible
+    HANDLE file = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    // Marking the file sparse keeps the untouched parts of the table off the disk
+    DWORD unused;
+    DeviceIoControl(file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &unused, nullptr);
+
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(bytes);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (base == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
     }
+
+    *outBase = static_cast<uint8_t*>(base);
+    *outMappedBytes = bytes;
+    *outFileHandle = reinterpret_cast<intptr_t>(file);
+    *outMappingHandle = mapping;
+#else
+    std::string pattern = directory + "/cnr-states-XXXXXX";
+    std::vector<char> fileName(pattern.begin(), pattern.end());
+    fileName.push_back('\0');
+
+    int fd = mkstemp(fileName.data());
+    if (fd < 0) return false;
+    unlink(fileName.data()); // The descriptor and the mapping keep it alive until the process ends
+
+    size_t pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t mappedBytes = roundUp(bytes, pageBytes);
+
+    // ftruncate only sets the length, so the file is all holes and reads back as zeros
+    if (ftruncate(fd, static_cast<off_t>(mappedBytes)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    *outBase = static_cast<uint8_t*>(base);
+    *outMappedBytes = mappedBytes;
+    *outFileHandle = fd;
+    *outMappingHandle = nullptr;
+#endif
+
+    return true;
+
+}
+
+void Allocator::releaseResident() {
+
+    for (const Arena& arena : this->memoryBlocks) {
+        if (arena.source != ArenaSource::FILE) continue;
+
+#ifdef _WIN32
+        // Flushing makes the pages clean, and unlocking pages that were never locked drops them from the working set
+        FlushViewOfFile(arena.base, 0);
+        VirtualUnlock(arena.base, arena.mappedBytes);
+#else
+        int fd = static_cast<int>(arena.fileHandle);
+
+        // Write everything dirty back, unmap the pages from this process, then evict them from the page cache
+        msync(arena.base, arena.mappedBytes, MS_SYNC);
+        madvise(arena.base, arena.mappedBytes, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#else
+        (void)fd;
+#endif
+#endif
+    }
+
+    return;
+
+}
+
+bool Allocator::parsePlacement(const std::string& name, Placement* outPlacement) {
+
+    if (name == "first-touch") *outPlacement = Placement::FIRST_TOUCH;
+    else if (name == "interleave") *outPlacement = Placement::INTERLEAVE;
+    else if (name == "partition") *outPlacement = Placement::PARTITIONED;
+    else return false;
+
+    return true;
+
+}
+
+int Allocator::getNodeCount() const {
+    return this->topology.nodeCount;
+}
+
+size_t Allocator::getArenaCount() const {
+    return this->memoryBlocks.size();
+}
+
+uint8_t* Allocator::getArenaBase(size_t i) const {
+    return this->memoryBlocks[i].base;
+}
+
+size_t Allocator::getArenaBytes(size_t i) const {
+    return this->memoryBlocks[i].usedBytes;
+}
+
+bool Allocator::parseHugePages(const std::string& name, HugePages* outMode) {
+
+    if (name == "none") *outMode = HugePages::NONE;
+    else if (name == "thp") *outMode = HugePages::TRANSPARENT;
+    else if (name == "reserved") *outMode = HugePages::RESERVED;
+    else return false;
+
+    return true;
+
 }
 
 void Allocator::trackExternal(const std::string& name, size_t sizeBytes, void* address) {
     // Add directly to the tracking map as active and external (blockId = -1)
-    this->trackingMap[name] = {sizeBytes, address, false, true, -1};
+    this->trackingMap[name] = {sizeBytes, address, false, true, -1, Placement::FIRST_TOUCH};
     this->totalExternalBytes += sizeBytes;
 }
 
@@ -31,18 +217,75 @@ void Allocator::allocate() {
         // Bitwise magic to push the offset forward to the nearest alignment boundary
         currentOffset = (currentOffset + req.alignment - 1) & ~(req.alignment - 1);
         currentOffset += req.sizeBytes;
+        if (req.placement != Placement::FIRST_TOUCH) currentOffset = roundUp(currentOffset, PLACEMENT_ALIGNMENT);
     }
 
-    // 2. Allocate the massive contiguous block
-    uint8_t* massiveBlock = new uint8_t[currentOffset];
-    
+    // 2. Map the massive contiguous block. Fresh anonymous pages read as zero and are only backed by real memory
+    // on their first write, so there is no serial zeroing pass and untouched parts of a table cost nothing
+    Arena arena = {nullptr, 0, currentOffset, ArenaSource::HEAP, -1, nullptr};
+    bool wantHuge = (this->hugePages != HugePages::NONE && currentOffset >= HUGE_PAGE_BYTES);
+
+    // A backing file replaces the anonymous mapping entirely (huge pages do not apply to it)
+    if (!this->backingDirectory.empty()) {
+        if (mapBackingFile(this->backingDirectory, currentOffset, &arena.base, &arena.mappedBytes,
+                           &arena.fileHandle, &arena.mappingHandle)) {
+            arena.source = ArenaSource::FILE;
+            wantHuge = false;
+        } else {
+            std::cerr << "Warning: Could not create a backing file in " << this->backingDirectory
+                      << ". Keeping this arena in RAM.\n";
+        }
+    }
+
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege on Windows, so only normal pages are requested here
+    (void)wantHuge;
+    if (arena.base == nullptr) {
+        arena.mappedBytes = currentOffset;
+        arena.base = static_cast<uint8_t*>(VirtualAlloc(nullptr, currentOffset, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (arena.base != nullptr) arena.source = ArenaSource::MAPPED;
+    }
+#else
+    size_t pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* base = (arena.base != nullptr) ? arena.base : MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    // Reserved huge pages fail outright (rather than falling back) when the pool is empty or too small
+    if (wantHuge && this->hugePages == HugePages::RESERVED) {
+        arena.mappedBytes = roundUp(currentOffset, HUGE_PAGE_BYTES);
+        base = mmap(nullptr, arena.mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) arena.source = ArenaSource::MAPPED_HUGETLB;
+    }
+#endif
+
+    if (base == MAP_FAILED) {
+        arena.mappedBytes = roundUp(currentOffset, pageBytes);
+        base = mmap(nullptr, arena.mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base != MAP_FAILED) {
+            arena.source = ArenaSource::MAPPED;
+#ifdef MADV_HUGEPAGE
+            if (wantHuge && madvise(base, arena.mappedBytes, MADV_HUGEPAGE) == 0) arena.source = ArenaSource::MAPPED_THP;
+#endif
+        }
+    }
+
+    arena.base = (base != MAP_FAILED) ? static_cast<uint8_t*>(base) : nullptr;
+#endif
+
+    // Last resort, the heap has to be zeroed by hand
+    if (arena.base == nullptr) {
+        arena.base = new uint8_t[currentOffset];
+        arena.mappedBytes = currentOffset;
+        arena.source = ArenaSource::HEAP;
+        std::memset(arena.base, 0, currentOffset);
+    }
+
+    uint8_t* massiveBlock = arena.base;
+
     // The ID of this new arena will just be its index in the memoryBlocks vector
     int currentBlockId = static_cast<int>(this->memoryBlocks.size());
     
-    // Safety zero-out (optional, but good for your DP tables)
-    std::memset(massiveBlock, 0, currentOffset);
-    
-    this->memoryBlocks.push_back(massiveBlock);
+    this->memoryBlocks.push_back(arena);
     this->totalAllocatedBytes += currentOffset;
 
     // 3. Do a second pass to assign the calculated pointers
@@ -58,7 +301,22 @@ void Allocator::allocate() {
         this->trackingMap[req.name].isPending = false;
         this->trackingMap[req.name].blockId = currentBlockId;
 
+        // Set the memory policy before anything touches the pages (a policy set later only moves what is already there)
+        uint8_t* start = massiveBlock + currentOffset;
+        if (req.placement == Placement::INTERLEAVE) {
+            this->topology.interleave(start, req.sizeBytes);
+        } else if (req.placement == Placement::PARTITIONED) {
+            for (int node = 0; node < this->topology.nodeCount; ++node) {
+                size_t sliceBegin = (req.sizeBytes * node / this->topology.nodeCount) & ~(PLACEMENT_ALIGNMENT - 1);
+                size_t sliceEnd = (node + 1 == this->topology.nodeCount)
+                                ? roundUp(req.sizeBytes, PLACEMENT_ALIGNMENT)
+                                : (req.sizeBytes * (node + 1) / this->topology.nodeCount) & ~(PLACEMENT_ALIGNMENT - 1);
+                this->topology.preferNode(start + sliceBegin, sliceEnd - sliceBegin, node);
+            }
+        }
+
         currentOffset += req.sizeBytes;
+        if (req.placement != Placement::FIRST_TOUCH) currentOffset = roundUp(currentOffset, PLACEMENT_ALIGNMENT);
     }
 
     // 4. Clear pending state
@@ -107,8 +365,32 @@ void Allocator::print() const {
         }
     }
     
+    // Arena headers name their backing, e.g. "Arena Block 1 (mmap, THP)"
+    auto arenaHeader = [&](int blockId) {
+        static const char* sourceNames[] = {"heap", "mmap", "mmap, THP", "mmap, hugetlb", "file"};
+        return "    -> Arena Block " + std::to_string(blockId + 1) + " ("
+               + sourceNames[static_cast<int>(this->memoryBlocks[blockId].source)] + ") ";
+    };
+
     for (const auto& blockPair : managedBlocks) {
-        maxTier1 = std::max(maxTier1, std::string("    -> Arena Block " + std::to_string(blockPair.first) + " ").length());
+        maxTier1 = std::max(maxTier1, arenaHeader(blockPair.first).length());
+    }
+
+    // Where the managed pages actually live, shown on NUMA machines or once any request asked for a placement
+    bool showPlacement = (this->topology.nodeCount > 1);
+    for (const auto& pair : this->trackingMap) {
+        if (!pair.second.isPending && !pair.second.isExternal && pair.second.placement != Placement::FIRST_TOUCH) showPlacement = true;
+    }
+
+    std::vector<uint64_t> nodeBytes(this->topology.nodeCount, 0);
+    uint64_t untouchedBytes = 0;
+    if (showPlacement) {
+        for (const auto& pair : this->trackingMap) {
+            if (pair.second.isPending || pair.second.isExternal) continue;
+            this->topology.countResidentBytes(pair.second.address, pair.second.sizeBytes, &nodeBytes, &untouchedBytes);
+        }
+        maxTier0 = std::max(maxTier0, std::string("   NUMA Placement (Resident) ").length());
+        maxTier1 = std::max(maxTier1, std::string("    -> Not Yet Touched ").length());
     }
 
     // Apply exact padding rules based on the longest bottom tier
@@ -175,7 +457,7 @@ void Allocator::print() const {
             uint64_t blockSize = 0;
             for (const auto& name : blockPair.second) blockSize += this->trackingMap.at(name).sizeBytes;
             
-            printLine(1, "    -> Arena Block " + std::to_string(blockPair.first + 1) + " ", blockSize, true);
+            printLine(1, arenaHeader(blockPair.first), blockSize, true);
             
             // Sort to print sequentially in physical memory order
             std::sort(blockPair.second.begin(), blockPair.second.end(), [&](const std::string& a, const std::string& b) {
@@ -205,5 +487,17 @@ void Allocator::print() const {
         std::cout << "||\n";
     }
     
+    if (showPlacement) {
+        uint64_t residentBytes = 0;
+        for (uint64_t bytes : nodeBytes) residentBytes += bytes;
+
+        printLine(0, "   NUMA Placement (Resident) ", residentBytes);
+        for (int node = 0; node < this->topology.nodeCount; ++node) {
+            printLine(1, "    -> Node " + std::to_string(this->topology.nodeIds[node]) + " ", nodeBytes[node], true);
+        }
+        printLine(1, "    -> Not Yet Touched ", untouchedBytes, true);
+        std::cout << "||\n";
+    }
+    
     std::cout << "||>>>>>>>>>>>>>>>>================------------------================<<<<<<<<<<<<<<<<\n\n";
 }
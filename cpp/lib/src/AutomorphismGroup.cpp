@@ -0,0 +1,330 @@
+#include "AutomorphismGroup.h"
+#include "copconfig.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// Recursive backtracking over the BFS order. Maps order[depth] onto every consistent candidate image.
+// Returns false once more than maxOrder automorphisms have been found
+static bool extendAutomorphism(const Graph* g, int depth, const std::vector<int>& order, const std::vector<int>& parent,
+                               const std::vector<int>& invariant, std::vector<int>& image, std::vector<bool>& used,
+                               std::vector<uint8_t>& outPerms, size_t maxOrder) {
+
+    int N = g->nodeCount;
+
+    // Every node is mapped, record the automorphism
+    if (depth == N) {
+        if (outPerms.size() / N >= maxOrder) return false;
+        for (int v = 0; v < N; ++v) {
+            outPerms.push_back(static_cast<uint8_t>(image[v]));
+        }
+        return true;
+    }
+
+    int u = order[depth];
+
+    for (int cand = 0; cand < N; ++cand) {
+
+        if (used[cand] || invariant[cand] != invariant[u]) continue;
+
+        // Nodes discovered through a BFS parent must land next to the parent's image
+        if (parent[u] != -1 && !g->getEdge(image[parent[u]], cand)) continue;
+
+        // Adjacency with every previously mapped node must be preserved
+        bool consistent = true;
+        for (int j = 0; j < depth; ++j) {
+            int w = order[j];
+            if (g->getEdge(u, w) != g->getEdge(cand, image[w])) {
+                consistent = false;
+                break;
+            }
+        }
+        if (!consistent) continue;
+
+        image[u] = cand;
+        used[cand] = true;
+
+        bool ok = extendAutomorphism(g, depth + 1, order, parent, invariant, image, used, outPerms, maxOrder);
+
+        used[cand] = false;
+        image[u] = -1;
+
+        if (!ok) return false;
+    }
+
+    return true;
+
+}
+
+AutomorphismGroup::~AutomorphismGroup() {
+    delete[] this->perms;
+    delete[] this->orbitReps;
+    delete[] this->cosetHeads;
+    delete[] this->cosets;
+}
+
+bool AutomorphismGroup::constructFrom(Graph* g, size_t maxOrder) {
+
+    int N = g->nodeCount;
+
+    // Step 1: Node invariants (degree, and the sum of neighbour degrees) prune impossible images early
+    std::vector<int> degree(N, 0);
+    for (int u = 0; u < N; ++u) {
+        for (int v = 0; v < N; ++v) {
+            if (g->getEdge(u, v)) degree[u]++;
+        }
+    }
+
+    std::vector<int> invariant(N, 0);
+    for (int u = 0; u < N; ++u) {
+        int neighbourDegrees = 0;
+        for (int v = 0; v < N; ++v) {
+            if (g->getEdge(u, v)) neighbourDegrees += degree[v];
+        }
+        invariant[u] = degree[u] * (N * N + 1) + neighbourDegrees;
+    }
+
+    // Step 2: BFS order, so every non-root node has an already mapped neighbour constraining its image
+    std::vector<int> order;
+    std::vector<int> parent(N, -1);
+    std::vector<bool> seen(N, false);
+    order.reserve(N);
+
+    for (int root = 0; root < N; ++root) {
+        if (seen[root]) continue;
+        seen[root] = true;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            int u = order[head++];
+            for (int v = 0; v < N; ++v) {
+                if (!seen[v] && g->getEdge(u, v)) {
+                    seen[v] = true;
+                    parent[v] = u;
+                    order.push_back(v);
+                }
+            }
+        }
+    }
+
+    // Step 3: Enumerate
+    std::vector<int> image(N, -1);
+    std::vector<bool> used(N, false);
+    std::vector<uint8_t> found;
+
+    bool complete = extendAutomorphism(g, 0, order, parent, invariant, image, used, found, maxOrder);
+
+    if (!complete) {
+        std::cerr << "Warning: Automorphism group exceeds " << maxOrder << " elements. Symmetry reduction disabled.\n";
+        this->useTrivialGroup(N);
+        return false;
+    }
+
+    delete[] this->perms;
+    this->nodeCount = N;
+    this->order = found.size() / N;
+    this->perms = new uint8_t[found.size()];
+    std::memcpy(this->perms, found.data(), found.size());
+
+    this->buildOrbits();
+
+    return true;
+
+}
+
+bool AutomorphismGroup::constructFromGenerators(Graph* g, const char* fileName, size_t maxOrder) {
+
+    int N = g->nodeCount;
+
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        std::cerr << "Warning: Could not open generator file " << fileName << ". Symmetry reduction disabled.\n";
+        this->useTrivialGroup(N);
+        return false;
+    }
+
+    // Step 1: Parse and validate the generators
+    std::vector<std::string> generators;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream tokens(line);
+        std::string perm(N, '\0');
+        std::vector<bool> hit(N, false);
+        int count = 0;
+        int value;
+        bool valid = true;
+
+        while (tokens >> value) {
+            if (count >= N || value < 0 || value >= N || hit[value]) { valid = false; break; }
+            hit[value] = true;
+            perm[count++] = static_cast<char>(value);
+        }
+        if (count == 0 && valid) continue;
+
+        for (int u = 0; valid && u < N; ++u) {
+            for (int v = 0; v < N; ++v) {
+                if (g->getEdge(u, v) != g->getEdge((uint8_t)perm[u], (uint8_t)perm[v])) { valid = false; break; }
+            }
+        }
+
+        if (!valid || count != N) {
+            std::cerr << "Warning: Generator \"" << line << "\" is not an automorphism of the graph. Symmetry reduction disabled.\n";
+            this->useTrivialGroup(N);
+            return false;
+        }
+
+        generators.push_back(perm);
+    }
+
+    // Step 2: Close under composition with a BFS over group elements
+    std::string identity(N, '\0');
+    for (int v = 0; v < N; ++v) identity[v] = static_cast<char>(v);
+
+    std::set<std::string> seen = {identity};
+    std::vector<std::string> elements = {identity};
+
+    for (size_t head = 0; head < elements.size(); ++head) {
+        for (const std::string& gen : generators) {
+            std::string next(N, '\0');
+            for (int v = 0; v < N; ++v) {
+                next[v] = gen[(uint8_t)elements[head][v]];
+            }
+            if (seen.insert(next).second) {
+                if (elements.size() >= maxOrder) {
+                    std::cerr << "Warning: Generated group exceeds " << maxOrder << " elements. Symmetry reduction disabled.\n";
+                    this->useTrivialGroup(N);
+                    return false;
+                }
+                elements.push_back(next);
+            }
+        }
+    }
+
+    delete[] this->perms;
+    this->nodeCount = N;
+    this->order = elements.size();
+    this->perms = new uint8_t[this->order * N];
+    for (size_t i = 0; i < this->order; ++i) {
+        std::memcpy(&this->perms[i * N], elements[i].data(), N);
+    }
+
+    this->buildOrbits();
+
+    return true;
+
+}
+
+int AutomorphismGroup::canonicalize(const uint8_t* config, int k, int r, uint8_t* outConfig) const {
+
+    uint8_t image[MAX_COPS];
+    bool first = true;
+
+    for (size_t i = this->cosetHeads[r]; i < this->cosetHeads[r + 1]; ++i) {
+        const uint8_t* perm = this->getPermutation(this->cosets[i]);
+
+        for (int c = 0; c < k; ++c) image[c] = perm[config[c]];
+        std::sort(image, image + k);
+
+        if (first || std::memcmp(image, outConfig, k) < 0) {
+            std::memcpy(outConfig, image, k);
+            first = false;
+        }
+    }
+
+    return this->orbitReps[r];
+
+}
+
+bool AutomorphismGroup::isCanonical(const uint8_t* config, int k, int r) const {
+
+    uint8_t image[MAX_COPS];
+
+    // r is its own orbit representative, so its coset is exactly its stabiliser
+    for (size_t i = this->cosetHeads[r]; i < this->cosetHeads[r + 1]; ++i) {
+        const uint8_t* perm = this->getPermutation(this->cosets[i]);
+
+        for (int c = 0; c < k; ++c) image[c] = perm[config[c]];
+        std::sort(image, image + k);
+
+        if (std::memcmp(image, config, k) < 0) return false;
+    }
+
+    return true;
+
+}
+
+size_t AutomorphismGroup::getMemoryFootprint() const {
+    return sizeof(*this) + this->order * this->nodeCount + this->nodeCount
+         + (this->nodeCount + 1) * sizeof(size_t) + this->cosetHeads[this->nodeCount] * sizeof(uint32_t);
+}
+
+void AutomorphismGroup::useTrivialGroup(int nodeCount) {
+
+    delete[] this->perms;
+
+    this->nodeCount = nodeCount;
+    this->order = 1;
+    this->perms = new uint8_t[nodeCount];
+    for (int v = 0; v < nodeCount; ++v) {
+        this->perms[v] = static_cast<uint8_t>(v);
+    }
+
+    this->buildOrbits();
+
+    return;
+
+}
+
+void AutomorphismGroup::buildOrbits() {
+
+    int N = this->nodeCount;
+
+    delete[] this->orbitReps;
+    delete[] this->cosetHeads;
+    delete[] this->cosets;
+
+    // Step 1: The orbit of v is {g(v)}, so its representative is the smallest image
+    this->orbitReps = new uint8_t[N];
+    this->orbitCount = 0;
+    for (int v = 0; v < N; ++v) {
+        uint8_t rep = static_cast<uint8_t>(v);
+        for (size_t i = 0; i < this->order; ++i) {
+            rep = std::min(rep, this->getPermutation(i)[v]);
+        }
+        this->orbitReps[v] = rep;
+        if (rep == v) this->orbitCount++;
+    }
+
+    // Step 2: CSR lists of the automorphisms carrying each node onto its representative
+    this->cosetHeads = new size_t[N + 1];
+    this->cosetHeads[0] = 0;
+    for (int v = 0; v < N; ++v) {
+        size_t count = 0;
+        for (size_t i = 0; i < this->order; ++i) {
+            if (this->getPermutation(i)[v] == this->orbitReps[v]) count++;
+        }
+        this->cosetHeads[v + 1] = this->cosetHeads[v] + count;
+    }
+
+    this->cosets = new uint32_t[this->cosetHeads[N]];
+    size_t offset = 0;
+    for (int v = 0; v < N; ++v) {
+        for (size_t i = 0; i < this->order; ++i) {
+            if (this->getPermutation(i)[v] == this->orbitReps[v]) {
+                this->cosets[offset++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    return;
+
+}
@@ -0,0 +1,378 @@
+#include "Checkpoint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+
+// Granularity of the dirty page tracking, and of the layout of the file
+static constexpr size_t PAGE_BYTES = 4096;
+
+// Pages one task of a save or load hashes (and writes or reads in as few calls as it can)
+static constexpr size_t TASK_PAGES = 256;
+
+static constexpr uint64_t CHECKPOINT_MAGIC = 0x54504b4352524e43ull; // "CNRRCKPT"
+static constexpr uint64_t CHECKPOINT_VERSION = 1;
+static constexpr size_t MAX_REGIONS = 16;
+static constexpr size_t MAX_COUNTERS = 32;
+
+// Header of one slot, at the start of its own page. checksum covers every field before it
+struct SlotHeader {
+    uint64_t magic;
+    uint64_t version;
+    uint64_t sequence;
+    uint64_t fingerprint;
+    uint64_t regionCount;
+    uint64_t regionBytes[MAX_REGIONS];
+    uint64_t counterCount;
+    uint64_t counters[MAX_COUNTERS];
+    uint64_t checksum;
+};
+
+static_assert(sizeof(SlotHeader) <= PAGE_BYTES, "A slot header has to fit its page");
+
+static uint64_t getPageCount(size_t bytes) {
+    return (bytes + PAGE_BYTES - 1) / PAGE_BYTES;
+}
+
+Checkpoint::~Checkpoint() {
+
+    if (this->fileHandle == -1) return;
+
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(this->fileHandle));
+#else
+    close(static_cast<int>(this->fileHandle));
+#endif
+
+}
+
+bool Checkpoint::constructFrom(const std::string& path, uint64_t fingerprint, bool resume) {
+
+    this->fingerprint = fingerprint;
+
+    // A new file is all holes, so both slots are known to hold zero pages
+    this->hashesKnown[0] = !resume;
+    this->hashesKnown[1] = !resume;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              resume ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    this->fileHandle = reinterpret_cast<intptr_t>(file);
+#else
+    int fd = open(path.c_str(), resume ? O_RDWR : (O_RDWR | O_CREAT | O_TRUNC), 0644);
+    if (fd < 0) return false;
+    this->fileHandle = fd;
+#endif
+
+    return true;
+
+}
+
+void Checkpoint::addRegion(void* base, size_t bytes) {
+
+    Region region;
+    region.base = static_cast<uint8_t*>(base);
+    region.bytes = bytes;
+    region.slotOffset = this->slotBytes;
+
+    // Every page starts out as it reads in a new file. The last page may be partial, and hashes only its part
+    uint64_t pageCount = getPageCount(bytes);
+    uint64_t zeroHash = 0;
+    uint64_t tailHash = 0;
+    if (pageCount > 0) {
+        std::vector<uint8_t> zeros(PAGE_BYTES, 0);
+        zeroHash = hashBytes(zeros.data(), PAGE_BYTES);
+        tailHash = hashBytes(zeros.data(), bytes - (pageCount - 1) * PAGE_BYTES);
+    }
+    for (int slot = 0; slot < 2; ++slot) {
+        region.pageHashes[slot].assign(pageCount, zeroHash);
+        if (pageCount > 0) region.pageHashes[slot].back() = tailHash;
+    }
+
+    this->slotBytes += pageCount * PAGE_BYTES;
+    this->regions.push_back(std::move(region));
+
+    return;
+
+}
+
+uint64_t Checkpoint::getHeaderOffset(int slot) const {
+    return static_cast<uint64_t>(slot) * PAGE_BYTES;
+}
+
+uint64_t Checkpoint::getDataOffset(int slot) const {
+    return 2 * PAGE_BYTES + static_cast<uint64_t>(slot) * this->slotBytes;
+}
+
+bool Checkpoint::writeAt(uint64_t offset, const void* data, size_t bytes) {
+
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+
+    while (bytes > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, (size_t)1 << 30));
+        DWORD written = 0;
+        if (!WriteFile(reinterpret_cast<HANDLE>(this->fileHandle), source, chunk, &written, &at) || written == 0) return false;
+#else
+        ssize_t written = pwrite(static_cast<int>(this->fileHandle), source, bytes, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+#endif
+        source += written;
+        offset += written;
+        bytes -= written;
+    }
+
+    return true;
+
+}
+
+bool Checkpoint::readAt(uint64_t offset, void* data, size_t bytes) const {
+
+    uint8_t* target = static_cast<uint8_t*>(data);
+
+    while (bytes > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, (size_t)1 << 30));
+        DWORD got = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(this->fileHandle), target, chunk, &got, &at) || got == 0) return false;
+#else
+        ssize_t got = pread(static_cast<int>(this->fileHandle), target, bytes, static_cast<off_t>(offset));
+        if (got <= 0) return false;
+#endif
+        target += got;
+        offset += got;
+        bytes -= got;
+    }
+
+    return true;
+
+}
+
+bool Checkpoint::resize(uint64_t bytes) {
+
+#ifdef _WIN32
+    LARGE_INTEGER end = {};
+    end.QuadPart = static_cast<LONGLONG>(bytes);
+    return SetFilePointerEx(reinterpret_cast<HANDLE>(this->fileHandle), end, nullptr, FILE_BEGIN) &&
+           SetEndOfFile(reinterpret_cast<HANDLE>(this->fileHandle));
+#else
+    return ftruncate(static_cast<int>(this->fileHandle), static_cast<off_t>(bytes)) == 0;
+#endif
+
+}
+
+bool Checkpoint::sync() {
+
+#ifdef _WIN32
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(this->fileHandle)) != 0;
+#else
+    return fsync(static_cast<int>(this->fileHandle)) == 0;
+#endif
+
+}
+
+bool Checkpoint::save(ThreadPool& pool, const std::vector<uint64_t>& counters) {
+
+    if (this->fileHandle == -1 || this->regions.size() > MAX_REGIONS || counters.size() > MAX_COUNTERS) return false;
+
+    // The newest checkpoint sits in slot sequence % 2, so this one goes to the other
+    uint64_t nextSequence = this->sequence + 1;
+    int slot = static_cast<int>(nextSequence % 2);
+    bool known = this->hashesKnown[slot];
+
+    // From here on the slot is half written until its header goes out
+    this->hashesKnown[slot] = false;
+    if (!this->resize(this->getDataOffset(2))) return false;
+
+    std::atomic<uint64_t> written{0};
+    std::atomic<bool> failed{false};
+
+    for (Region& region : this->regions) {
+        uint64_t pageCount = getPageCount(region.bytes);
+        uint64_t* hashes = region.pageHashes[slot].data();
+        uint64_t fileBase = this->getDataOffset(slot) + region.slotOffset;
+
+        pool.parallelFor(pageCount, TASK_PAGES, [&](unsigned int, size_t beginPage, size_t endPage) {
+            size_t runBegin = beginPage;
+            size_t runEnd = beginPage;
+
+            // Writes the run of changed pages [runBegin, runEnd) in one call
+            auto flushRun = [&]() {
+                if (runEnd == runBegin) return;
+                size_t offset = runBegin * PAGE_BYTES;
+                size_t bytes = std::min(runEnd * PAGE_BYTES, region.bytes) - offset;
+                if (!this->writeAt(fileBase + offset, region.base + offset, bytes)) failed.store(true, std::memory_order_relaxed);
+                written.fetch_add(bytes, std::memory_order_relaxed);
+            };
+
+            for (size_t page = beginPage; page < endPage; ++page) {
+                size_t offset = page * PAGE_BYTES;
+                uint64_t hash = hashBytes(region.base + offset, std::min(PAGE_BYTES, region.bytes - offset));
+
+                if (!known || hash != hashes[page]) {
+                    if (runEnd != page) {
+                        flushRun();
+                        runBegin = page;
+                    }
+                    runEnd = page + 1;
+                    hashes[page] = hash;
+                }
+            }
+            flushRun();
+        });
+    }
+
+    if (failed.load() || !this->sync()) return false;
+
+    // The data is on disk, so the header can now make the slot the newest
+    SlotHeader header = {};
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.sequence = nextSequence;
+    header.fingerprint = this->fingerprint;
+    header.regionCount = this->regions.size();
+    for (size_t i = 0; i < this->regions.size(); ++i) header.regionBytes[i] = this->regions[i].bytes;
+    header.counterCount = counters.size();
+    std::copy(counters.begin(), counters.end(), header.counters);
+    header.checksum = hashBytes(&header, offsetof(SlotHeader, checksum));
+
+    if (!this->writeAt(this->getHeaderOffset(slot), &header, sizeof(header)) || !this->sync()) return false;
+
+    this->hashesKnown[slot] = true;
+    this->sequence = nextSequence;
+    this->saveCount++;
+    this->lastWrittenBytes = written.load() + sizeof(header);
+    this->totalWrittenBytes += this->lastWrittenBytes;
+
+    return true;
+
+}
+
+bool Checkpoint::load(ThreadPool& pool, std::vector<uint64_t>* counters) {
+
+    if (this->fileHandle == -1 || this->regions.size() > MAX_REGIONS) return false;
+
+    // Pick the newest slot whose header is whole and was written for this problem and these regions
+    SlotHeader newest = {};
+    int slot = -1;
+    for (int s = 0; s < 2; ++s) {
+        SlotHeader header;
+        if (!this->readAt(this->getHeaderOffset(s), &header, sizeof(header))) continue;
+        if (header.magic != CHECKPOINT_MAGIC || header.version != CHECKPOINT_VERSION) continue;
+        if (header.checksum != hashBytes(&header, offsetof(SlotHeader, checksum))) continue;
+        if (header.fingerprint != this->fingerprint || header.regionCount != this->regions.size()) continue;
+        if (header.counterCount > MAX_COUNTERS || header.sequence % 2 != static_cast<uint64_t>(s)) continue;
+
+        bool sameRegions = true;
+        for (size_t i = 0; i < this->regions.size(); ++i) {
+            if (header.regionBytes[i] != this->regions[i].bytes) sameRegions = false;
+        }
+        if (!sameRegions) continue;
+
+        if (slot == -1 || header.sequence > newest.sequence) {
+            newest = header;
+            slot = s;
+        }
+    }
+    if (slot == -1) return false;
+
+    std::atomic<bool> failed{false};
+
+    for (Region& region : this->regions) {
+        uint64_t pageCount = getPageCount(region.bytes);
+        uint64_t* hashes = region.pageHashes[slot].data();
+        uint64_t fileBase = this->getDataOffset(slot) + region.slotOffset;
+
+        pool.parallelFor(pageCount, TASK_PAGES, [&](unsigned int, size_t beginPage, size_t endPage) {
+            size_t offset = beginPage * PAGE_BYTES;
+            size_t bytes = std::min(endPage * PAGE_BYTES, region.bytes) - offset;
+            if (!this->readAt(fileBase + offset, region.base + offset, bytes)) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            for (size_t page = beginPage; page < endPage; ++page) {
+                size_t pageOffset = page * PAGE_BYTES;
+                hashes[page] = hashBytes(region.base + pageOffset, std::min(PAGE_BYTES, region.bytes - pageOffset));
+            }
+        });
+    }
+
+    if (failed.load()) return false;
+
+    // What the other slot holds is unknown, so the first save into it writes every page
+    this->hashesKnown[slot] = true;
+    this->hashesKnown[1 - slot] = false;
+    this->sequence = newest.sequence;
+    counters->assign(newest.counters, newest.counters + newest.counterCount);
+
+    return true;
+
+}
+
+uint64_t Checkpoint::getRegionBytes() const {
+    uint64_t bytes = 0;
+    for (const Region& region : this->regions) bytes += region.bytes;
+    return bytes;
+}
+
+size_t Checkpoint::getMemoryFootprint() const {
+    size_t bytes = 0;
+    for (const Region& region : this->regions) {
+        bytes += (region.pageHashes[0].capacity() + region.pageHashes[1].capacity()) * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+uint64_t Checkpoint::hashBytes(const void* data, size_t bytes, uint64_t seed) {
+
+    // xxHash64's accumulator round over 64-bit words, plus its final avalanche
+    constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed ^ (static_cast<uint64_t>(bytes) * PRIME_1);
+
+    auto round = [&](uint64_t word) {
+        hash ^= word * PRIME_2;
+        hash = (hash << 31) | (hash >> 33);
+        hash *= PRIME_1;
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytePtr + i, 8);
+        round(word);
+    }
+    if (i < bytes) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytePtr + i, bytes - i);
+        round(word);
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+
+    return hash;
+
+}
@@ -0,0 +1,155 @@
+#include "CompressedTransitions.h"
+
+#include <utility>
+
+
+CompressedTransitions::CompressedTransitions(CompressedTransitions&& other) noexcept {
+    *this = std::move(other);
+}
+
+CompressedTransitions& CompressedTransitions::operator=(CompressedTransitions&& other) noexcept {
+
+    bool otherOwnsRows = (other.headsView == other.heads.data());
+
+    this->rowCount = other.rowCount;
+    this->edgeCount = other.edgeCount;
+    this->maxRowLength = other.maxRowLength;
+    this->encodedBytes = other.encodedBytes;
+    this->heads = std::move(other.heads);
+    this->data = std::move(other.data);
+
+    if (otherOwnsRows) {
+        this->refreshViews();
+    } else {
+        this->headsView = other.headsView;
+        this->dataView = other.dataView;
+    }
+
+    other.rowCount = 0;
+    other.edgeCount = 0;
+    other.maxRowLength = 0;
+    other.encodedBytes = 0;
+    other.heads.clear();
+    other.data.clear();
+    other.headsView = nullptr;
+    other.dataView = nullptr;
+
+    return *this;
+
+}
+
+void CompressedTransitions::reserve(size_t rowCount, size_t byteGuess) {
+
+    this->rowCount = 0;
+    this->edgeCount = 0;
+    this->maxRowLength = 0;
+    this->encodedBytes = 0;
+
+    this->heads.clear();
+    this->heads.reserve(rowCount + 1);
+    this->heads.push_back(0);
+
+    this->data.clear();
+    this->data.reserve(byteGuess);
+
+    this->refreshViews();
+
+    return;
+
+}
+
+void CompressedTransitions::appendRow(const size_t* ids, size_t count) {
+
+    if (this->heads.empty()) this->heads.push_back(0);
+
+    size_t offset = this->data.size();
+    this->data.resize(offset + encodedRowSize(ids, count));
+    encodeRow(ids, count, this->data.data() + offset);
+
+    this->heads.push_back(this->data.size());
+    this->encodedBytes = this->data.size();
+
+    this->rowCount++;
+    this->edgeCount += count;
+    if (count > this->maxRowLength) this->maxRowLength = count;
+
+    this->refreshViews();
+
+    return;
+
+}
+
+size_t CompressedTransitions::encodedRowSize(const size_t* ids, size_t count) {
+
+    size_t bytes = 0;
+    size_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t delta = ids[i] - prev;
+        prev = ids[i];
+
+        bytes++;
+        while (delta >= 0x80) {
+            delta >>= 7;
+            bytes++;
+        }
+    }
+
+    return bytes;
+
+}
+
+void CompressedTransitions::encodeRow(const size_t* ids, size_t count, uint8_t* out) {
+
+    size_t prev = 0;
+    for (size_t i = 0; i < count; ++i) {
+
+        // The first ID is stored as a gap from 0, the rest as gaps from their predecessor
+        size_t delta = ids[i] - prev;
+        prev = ids[i];
+
+        while (delta >= 0x80) {
+            *out++ = static_cast<uint8_t>(delta | 0x80);
+            delta >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(delta);
+    }
+
+    return;
+
+}
+
+void CompressedTransitions::attach(const size_t* heads, const uint8_t* data, size_t rowCount, size_t edgeCount, size_t maxRowLength) {
+
+    this->heads.clear();
+    this->heads.shrink_to_fit();
+    this->data.clear();
+    this->data.shrink_to_fit();
+
+    this->headsView = heads;
+    this->dataView = data;
+    this->rowCount = rowCount;
+    this->edgeCount = edgeCount;
+    this->maxRowLength = maxRowLength;
+    this->encodedBytes = heads[rowCount];
+
+    return;
+
+}
+
+size_t CompressedTransitions::getHeadsFootprint() const {
+    return this->heads.capacity() * sizeof(size_t);
+}
+
+size_t CompressedTransitions::getDataFootprint() const {
+    return this->data.capacity() * sizeof(uint8_t);
+}
+
+size_t CompressedTransitions::getUncompressedFootprint() const {
+    return (this->rowCount + 1 + this->edgeCount) * sizeof(size_t);
+}
+
+void CompressedTransitions::refreshViews() {
+    this->headsView = this->heads.data();
+    this->dataView = this->data.data();
+    return;
+}
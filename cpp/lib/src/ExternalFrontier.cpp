@@ -0,0 +1,339 @@
+#include "ExternalFrontier.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+
+// Entries each run's read window holds during a merge, at most (it shrinks when there are many runs) and at least
+// (beyond that, the runs are merged down in extra passes instead)
+static constexpr size_t MAX_WINDOW_ENTRIES = (size_t)1 << 16;
+static constexpr size_t MIN_WINDOW_ENTRIES = 1024;
+
+ExternalFrontier::~ExternalFrontier() {
+
+    if (this->fileHandle == -1) return;
+
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(this->fileHandle));
+#else
+    close(static_cast<int>(this->fileHandle));
+#endif
+
+}
+
+bool ExternalFrontier::constructFrom(const std::string& directory, size_t numStates, unsigned int numThreads,
+                                     size_t memoryBytes) {
+
+    this->numStates = numStates;
+    this->wideIds = (static_cast<uint64_t>(numStates) > ((uint64_t)1 << 32));
+    this->memoryBytes = memoryBytes;
+    this->bufferEntries = std::max<size_t>(memoryBytes / std::max(numThreads, 1u) / sizeof(uint64_t), 4096);
+    this->buffers.assign(std::max(numThreads, 1u), std::vector<uint64_t>());
+
+#ifdef _WIN32
+    char fileName[MAX_PATH];
+    if (GetTempFileNameA(directory.c_str(), "cnr", 0, fileName) == 0) return false;
+
+    HANDLE file = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    this->fileHandle = reinterpret_cast<intptr_t>(file);
+#else
+    std::string pattern = directory + "/cnr-frontier-XXXXXX";
+    std::vector<char> fileName(pattern.begin(), pattern.end());
+    fileName.push_back('\0');
+
+    int fd = mkstemp(fileName.data());
+    if (fd < 0) return false;
+    unlink(fileName.data()); // The descriptor keeps it alive until it is closed
+    this->fileHandle = fd;
+#endif
+
+    return true;
+
+}
+
+bool ExternalFrontier::writeAt(uint64_t offset, const void* data, size_t bytes) {
+
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+
+    while (bytes > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, (size_t)1 << 30));
+        DWORD written = 0;
+        if (!WriteFile(reinterpret_cast<HANDLE>(this->fileHandle), source, chunk, &written, &at) || written == 0) return false;
+#else
+        ssize_t written = pwrite(static_cast<int>(this->fileHandle), source, bytes, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+#endif
+        source += written;
+        offset += written;
+        bytes -= written;
+    }
+
+    return true;
+
+}
+
+bool ExternalFrontier::readAt(uint64_t offset, void* data, size_t bytes) const {
+
+    uint8_t* target = static_cast<uint8_t*>(data);
+
+    while (bytes > 0) {
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, (size_t)1 << 30));
+        DWORD got = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(this->fileHandle), target, chunk, &got, &at) || got == 0) return false;
+#else
+        ssize_t got = pread(static_cast<int>(this->fileHandle), target, bytes, static_cast<off_t>(offset));
+        if (got <= 0) return false;
+#endif
+        target += got;
+        offset += got;
+        bytes -= got;
+    }
+
+    return true;
+
+}
+
+void ExternalFrontier::spill(unsigned int tId) {
+
+    std::vector<uint64_t>& buffer = this->buffers[tId];
+    std::sort(buffer.begin(), buffer.end());
+    buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+
+    // Narrow IDs are packed down in place, the buffer is emptied right after anyway
+    size_t entryBytes = this->wideIds ? sizeof(uint64_t) : sizeof(uint32_t);
+    if (!this->wideIds) {
+        uint32_t* packed = reinterpret_cast<uint32_t*>(buffer.data());
+        for (size_t i = 0; i < buffer.size(); ++i) packed[i] = static_cast<uint32_t>(buffer[i]);
+    }
+
+    size_t bytes = buffer.size() * entryBytes;
+    uint64_t offset = this->fileEnd.fetch_add(bytes, std::memory_order_relaxed);
+    if (!this->writeAt(offset, buffer.data(), bytes)) {
+        std::cerr << "FATAL: Could not write " << bytes << " bytes to the frontier spill file.\n";
+        std::exit(1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->runsMutex);
+        this->runs.push_back({offset, buffer.size()});
+        this->totalSpilledRuns++;
+        this->totalSpilledBytes += bytes;
+    }
+
+    buffer.clear();
+
+    return;
+
+}
+
+size_t ExternalFrontier::drain(ThreadPool& pool, size_t batchEntries,
+                               const std::function<void(const uint64_t*, size_t)>& consume) {
+
+    // The buffers left over become in-memory runs
+    pool.run([&](unsigned int tId) {
+        for (size_t b = tId; b < this->buffers.size(); b += pool.numThreads) {
+            std::sort(this->buffers[b].begin(), this->buffers[b].end());
+        }
+    });
+
+    // Too many spilled runs for one merge are merged down first, then everything is merged in one last pass
+    this->reduceRuns();
+    size_t distinct = this->mergeRuns(this->runs, true, batchEntries, consume);
+
+    // Empty again, and the disk space goes back too
+    for (std::vector<uint64_t>& buffer : this->buffers) buffer.clear();
+    this->runs.clear();
+    this->fileEnd.store(0, std::memory_order_relaxed);
+#ifdef _WIN32
+    LARGE_INTEGER start = {};
+    SetFilePointerEx(reinterpret_cast<HANDLE>(this->fileHandle), start, nullptr, FILE_BEGIN);
+    SetEndOfFile(reinterpret_cast<HANDLE>(this->fileHandle));
+#else
+    if (ftruncate(static_cast<int>(this->fileHandle), 0) != 0) {
+        std::cerr << "Warning: Could not truncate the frontier spill file.\n";
+    }
+#endif
+
+    return distinct;
+
+}
+
+size_t ExternalFrontier::getMaxFanIn() const {
+    // One window per run plus the output batch, all at the smallest window size
+    return std::max<size_t>(this->memoryBytes / 4 / (MIN_WINDOW_ENTRIES * sizeof(uint64_t)), 3) - 1;
+}
+
+size_t ExternalFrontier::getWindowEntries(size_t runCount) const {
+    return std::min(MAX_WINDOW_ENTRIES, std::max(MIN_WINDOW_ENTRIES,
+                    this->memoryBytes / 4 / ((runCount + 1) * sizeof(uint64_t))));
+}
+
+void ExternalFrontier::reduceRuns() {
+
+    size_t fanIn = this->getMaxFanIn();
+    size_t entryBytes = this->wideIds ? sizeof(uint64_t) : sizeof(uint32_t);
+
+    while (this->runs.size() > fanIn) {
+
+        std::vector<Run> merged;
+        merged.reserve(this->runs.size() / fanIn + 1);
+
+        for (size_t first = 0; first < this->runs.size(); first += fanIn) {
+            std::vector<Run> group(this->runs.begin() + first, this->runs.begin() + std::min(first + fanIn, this->runs.size()));
+            if (group.size() == 1) {
+                merged.push_back(group[0]);
+                continue;
+            }
+
+            // The merged group becomes a new run at the end of the file, written one output batch at a time
+            Run run = {this->fileEnd.load(std::memory_order_relaxed), 0};
+            std::vector<uint32_t> narrow;
+
+            this->mergeRuns(group, false, this->getWindowEntries(group.size()), [&](const uint64_t* ids, size_t count) {
+                const void* data = ids;
+                if (!this->wideIds) {
+                    narrow.resize(count);
+                    for (size_t i = 0; i < count; ++i) narrow[i] = static_cast<uint32_t>(ids[i]);
+                    data = narrow.data();
+                }
+                if (!this->writeAt(run.offset + run.count * entryBytes, data, count * entryBytes)) {
+                    std::cerr << "FATAL: Could not write " << count * entryBytes << " bytes to the frontier spill file.\n";
+                    std::exit(1);
+                }
+                run.count += count;
+            });
+
+            this->fileEnd.fetch_add(run.count * entryBytes, std::memory_order_relaxed);
+            this->totalSpilledBytes += run.count * entryBytes;
+            merged.push_back(run);
+        }
+
+        this->runs.swap(merged);
+        this->totalMergePasses++;
+    }
+
+    return;
+
+}
+
+size_t ExternalFrontier::mergeRuns(const std::vector<Run>& group, bool withBuffers, size_t batchEntries,
+                                   const std::function<void(const uint64_t*, size_t)>& consume) {
+
+    // A reader per run: spilled runs stream through a window, in-memory runs are read in place
+    struct Reader {
+        const uint64_t* data;
+        size_t size;
+        size_t pos;
+        size_t nextEntry;      // Spilled runs: first entry not yet loaded into the window
+        const Run* run;        // nullptr for in-memory runs
+        std::vector<uint64_t> window;
+    };
+
+    size_t windowEntries = this->getWindowEntries(group.size());
+    size_t entryBytes = this->wideIds ? sizeof(uint64_t) : sizeof(uint32_t);
+    std::vector<uint32_t> narrow(this->wideIds ? 0 : windowEntries);
+
+    auto refill = [&](Reader& reader) {
+        size_t count = std::min(windowEntries, reader.run->count - reader.nextEntry);
+        reader.window.resize(count);
+        uint64_t offset = reader.run->offset + reader.nextEntry * entryBytes;
+        bool ok;
+        if (this->wideIds) {
+            ok = this->readAt(offset, reader.window.data(), count * entryBytes);
+        } else {
+            ok = this->readAt(offset, narrow.data(), count * entryBytes);
+            for (size_t i = 0; i < count; ++i) reader.window[i] = narrow[i];
+        }
+        if (!ok) {
+            std::cerr << "FATAL: Could not read back the frontier spill file.\n";
+            std::exit(1);
+        }
+        reader.nextEntry += count;
+        reader.data = reader.window.data();
+        reader.size = count;
+        reader.pos = 0;
+    };
+
+    std::vector<Reader> readers;
+    readers.reserve(group.size() + (withBuffers ? this->buffers.size() : 0));
+    for (const Run& run : group) {
+        readers.push_back({nullptr, 0, 0, 0, &run, {}});
+        refill(readers.back());
+    }
+    if (withBuffers) {
+        for (const std::vector<uint64_t>& buffer : this->buffers) {
+            if (!buffer.empty()) readers.push_back({buffer.data(), buffer.size(), 0, 0, nullptr, {}});
+        }
+    }
+
+    // Min-heap of (next ID, reader)
+    using Head = std::pair<uint64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    for (size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i].size > 0) heap.push({readers[i].data[0], i});
+    }
+
+    std::vector<uint64_t> batch;
+    batch.reserve(batchEntries);
+    size_t distinct = 0;
+    bool any = false;
+    uint64_t last = 0;
+
+    while (!heap.empty()) {
+        Head head = heap.top();
+        heap.pop();
+
+        if (!any || head.first != last) {
+            batch.push_back(head.first);
+            last = head.first;
+            any = true;
+            distinct++;
+            if (batch.size() == batchEntries) {
+                consume(batch.data(), batch.size());
+                batch.clear();
+            }
+        }
+
+        Reader& reader = readers[head.second];
+        reader.pos++;
+        if (reader.pos == reader.size && reader.run != nullptr && reader.nextEntry < reader.run->count) refill(reader);
+        if (reader.pos < reader.size) heap.push({reader.data[reader.pos], head.second});
+    }
+
+    if (!batch.empty()) consume(batch.data(), batch.size());
+
+    return distinct;
+
+}
+
+size_t ExternalFrontier::getSpilledRunCount() const {
+    return this->runs.size();
+}
+
+size_t ExternalFrontier::getMemoryFootprint() const {
+    size_t bytes = 0;
+    for (const std::vector<uint64_t>& buffer : this->buffers) bytes += buffer.capacity() * sizeof(uint64_t);
+    return bytes;
+}
@@ -96,6 +96,26 @@ bool Graph::getEdge(int node1, int node2) const {
 
 }
 
+void Graph::relabel(const int* newToOld) {
+
+    if (!this->g) return;
+
+    int N = this->nodeCount;
+    bool* relabelled = new bool[N * N];
+
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            relabelled[i * N + j] = this->g[newToOld[i] * N + newToOld[j]];
+        }
+    }
+
+    delete[] this->g;
+    this->g = relabelled;
+
+    return;
+
+}
+
 size_t Graph::getMemoryFootprint() const {
     return sizeof(*this) + (this->nodeCount * this->nodeCount * sizeof(bool));
 }
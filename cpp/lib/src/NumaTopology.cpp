@@ -0,0 +1,189 @@
+#include "NumaTopology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+    #include <dirent.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
+// Memory policy modes and flags from <linux/mempolicy.h>, spelled out so there is no libnuma (numaif.h) dependency
+static constexpr int MPOL_PREFERRED_MODE = 1;
+static constexpr int MPOL_INTERLEAVE_MODE = 3;
+static constexpr unsigned int MPOL_MF_MOVE_FLAG = 1 << 1;
+
+// move_pages() takes the pages in batches of this many
+static constexpr size_t QUERY_BATCH_PAGES = 4096;
+
+// Parses a sysfs CPU list such as "0-3,8-11" into its CPUs
+static std::vector<int> parseCpuList(const std::string& text) {
+
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string part;
+
+    while (std::getline(stream, part, ',')) {
+        if (part.empty() || part == "\n") continue;
+        size_t dash = part.find('-');
+        int first = std::stoi(part.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : std::stoi(part.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+
+    return cpus;
+
+}
+
+void NumaTopology::constructFrom() {
+
+    this->nodeIds.clear();
+    this->nodeCpus.clear();
+
+#ifdef __linux__
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir != nullptr) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                this->nodeIds.push_back(std::stoi(name.substr(4)));
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(this->nodeIds.begin(), this->nodeIds.end());
+
+    // Memory-only nodes (no CPUs, e.g. CXL expanders) are left out, no thread could ever be local to them
+    std::vector<int> cpuNodeIds;
+    for (int id : this->nodeIds) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string text;
+        std::getline(file, text);
+        std::vector<int> cpus = parseCpuList(text);
+        if (cpus.empty()) continue;
+        cpuNodeIds.push_back(id);
+        this->nodeCpus.push_back(cpus);
+    }
+    this->nodeIds = cpuNodeIds;
+#endif
+
+    // No NUMA information: one node with every core
+    if (this->nodeIds.empty()) {
+        unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+        this->nodeIds.push_back(0);
+        this->nodeCpus.emplace_back();
+        for (unsigned int cpu = 0; cpu < cores; ++cpu) this->nodeCpus[0].push_back(static_cast<int>(cpu));
+    }
+
+    this->nodeCount = static_cast<int>(this->nodeIds.size());
+
+    return;
+
+}
+
+bool NumaTopology::setPolicy(void* address, size_t bytes, int mode, const std::vector<int>& nodes) const {
+
+#if defined(__linux__) && defined(SYS_mbind)
+    size_t pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(address) + pageBytes - 1) & ~(pageBytes - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(address) + bytes) & ~(pageBytes - 1);
+    if (begin >= end) return true;
+
+    int maxId = *std::max_element(this->nodeIds.begin(), this->nodeIds.end());
+    std::vector<unsigned long> mask(maxId / (8 * sizeof(unsigned long)) + 1, 0);
+    for (int node : nodes) {
+        int id = this->nodeIds[node];
+        mask[id / (8 * sizeof(unsigned long))] |= 1ul << (id % (8 * sizeof(unsigned long)));
+    }
+
+    // The kernel reads maxnode - 1 bits of the mask
+    unsigned long maxNode = mask.size() * 8 * sizeof(unsigned long) + 1;
+    long result = syscall(SYS_mbind, begin, end - begin, mode, mask.data(), maxNode, MPOL_MF_MOVE_FLAG);
+    return (result == 0);
+#else
+    (void)address; (void)bytes; (void)mode; (void)nodes;
+    return false;
+#endif
+
+}
+
+bool NumaTopology::interleave(void* address, size_t bytes) const {
+
+    std::vector<int> nodes;
+    for (int node = 0; node < this->nodeCount; ++node) nodes.push_back(node);
+
+    return this->setPolicy(address, bytes, MPOL_INTERLEAVE_MODE, nodes);
+
+}
+
+bool NumaTopology::preferNode(void* address, size_t bytes, int node) const {
+    return this->setPolicy(address, bytes, MPOL_PREFERRED_MODE, {node});
+}
+
+bool NumaTopology::countResidentBytes(const void* address, size_t bytes, std::vector<uint64_t>* bytesPerNode,
+                                      uint64_t* untouchedBytes) const {
+
+    bytesPerNode->resize(this->nodeCount, 0);
+
+#if defined(__linux__) && defined(SYS_move_pages)
+    size_t pageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(address) & ~(pageBytes - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(address) + bytes;
+
+    std::vector<void*> pages;
+    std::vector<int> status;
+    pages.reserve(QUERY_BATCH_PAGES);
+    status.resize(QUERY_BATCH_PAGES);
+
+    for (uintptr_t batch = begin; batch < end; batch += QUERY_BATCH_PAGES * pageBytes) {
+        pages.clear();
+        for (uintptr_t page = batch; page < end && pages.size() < QUERY_BATCH_PAGES; page += pageBytes) {
+            pages.push_back(reinterpret_cast<void*>(page));
+        }
+
+        // With no target nodes, move_pages only reports where each page is (a negative errno if it has none yet)
+        if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) return false;
+
+        for (size_t i = 0; i < pages.size(); ++i) {
+            // Only the part of the first and last page inside the range counts
+            uintptr_t pageBegin = std::max(reinterpret_cast<uintptr_t>(pages[i]), reinterpret_cast<uintptr_t>(address));
+            uintptr_t pageEnd = std::min(reinterpret_cast<uintptr_t>(pages[i]) + pageBytes, end);
+            uint64_t inRange = pageEnd - pageBegin;
+
+            auto it = std::find(this->nodeIds.begin(), this->nodeIds.end(), status[i]);
+            if (status[i] < 0 || it == this->nodeIds.end()) *untouchedBytes += inRange;
+            else (*bytesPerNode)[it - this->nodeIds.begin()] += inRange;
+        }
+    }
+
+    return true;
+#else
+    (void)address;
+    *untouchedBytes += bytes;
+    return false;
+#endif
+
+}
+
+int NumaTopology::getNodeForThread(unsigned int t, unsigned int numThreads) const {
+    if (numThreads == 0) return 0;
+    return static_cast<int>((static_cast<uint64_t>(t) * this->nodeCount) / numThreads);
+}
+
+int NumaTopology::getCpuForThread(unsigned int t, unsigned int numThreads) const {
+
+    int node = this->getNodeForThread(t, numThreads);
+
+    // First thread of this node's run
+    unsigned int first = static_cast<unsigned int>((static_cast<uint64_t>(node) * numThreads + this->nodeCount - 1) / this->nodeCount);
+
+    const std::vector<int>& cpus = this->nodeCpus[node];
+    return cpus[(t - first) % cpus.size()];
+
+}
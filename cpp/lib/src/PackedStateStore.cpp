@@ -0,0 +1,51 @@
+#include "PackedStateStore.h"
+
+#include <string>
+
+
+// Both planes start out as the Allocator's zero pages, which are only valid atomics if an atomic word is a plain word
+static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "PackedStateStore relies on zeroed memory being a zeroed std::atomic<uint64_t>");
+
+
+void PackedStateStore::constructFrom(size_t numStates, int maxSafeMoves, Allocator* mem, bool counterless,
+                                     Allocator::Placement placement) {
+
+    this->numStates = numStates;
+    this->counterless = counterless;
+
+    // Smallest width that holds 0..maxSafeMoves, i.e. ceil(log2(maxSafeMoves + 1)). Counterless mode keeps one flag bit
+    this->counterBits = 1;
+    if (!counterless) {
+        while (((uint64_t)1 << this->counterBits) <= static_cast<uint64_t>(maxSafeMoves)) this->counterBits++;
+    }
+
+    this->countersPerWord = 64 / this->counterBits;
+    this->counterMask = ((uint64_t)1 << this->counterBits) - 1;
+
+    this->copWordCount = (numStates + 63) / 64;
+    this->counterWordCount = (numStates + this->countersPerWord - 1) / this->countersPerWord;
+
+    // Both planes go through the same std::atomic<uint64_t> word array, only the name and the meaning differ
+    std::atomic<uint64_t>* secondPlane = nullptr;
+    mem->requestAlloc("Cop Turn Wins (1 bit)", this->copWordCount, &this->copTurnWins, placement);
+    if (counterless) {
+        mem->requestAlloc("Robber Turn Wins (1 bit)", this->counterWordCount, &secondPlane, placement);
+    } else {
+        mem->requestAlloc("Robber Safe Moves (" + std::to_string(this->counterBits) + " bits)", this->counterWordCount, &secondPlane, placement);
+    }
+    mem->allocate();
+
+    if (counterless) {
+        this->robberTurnWins = secondPlane;
+    } else {
+        this->safeMoves = secondPlane;
+    }
+
+    return;
+
+}
+
+size_t PackedStateStore::getMemoryFootprint() const {
+    return (this->copWordCount + this->counterWordCount) * sizeof(uint64_t);
+}
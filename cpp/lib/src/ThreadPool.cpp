@@ -0,0 +1,221 @@
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+
+// Spins on a shared word before falling back to yield (or sleep), tuned for back to back waves
+static constexpr int SPIN_BEFORE_YIELD = 64;
+static constexpr int SPIN_BEFORE_SLEEP = 4096;
+
+
+/*   SpinBarrier   */
+
+void SpinBarrier::constructFrom(unsigned int participants) {
+    this->participants = participants;
+    this->arrived.store(0, std::memory_order_relaxed);
+    this->generation.store(0, std::memory_order_relaxed);
+    return;
+}
+
+void SpinBarrier::arriveAndWait() {
+
+    // Read the generation before arriving, or the last thread could bump it in between
+    unsigned int gen = this->generation.load(std::memory_order_acquire);
+
+    if (this->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == this->participants) {
+        this->arrived.store(0, std::memory_order_relaxed);
+        this->generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    int spins = 0;
+    while (this->generation.load(std::memory_order_acquire) == gen) {
+        if (++spins > SPIN_BEFORE_YIELD) std::this_thread::yield();
+    }
+
+    return;
+
+}
+
+
+/*   ThreadPool   */
+
+ThreadPool::~ThreadPool() {
+
+    {
+        std::lock_guard<std::mutex> lock(this->wakeMutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+
+    for (auto& t : this->workers) {
+        t.join();
+    }
+
+    delete[] this->ranges;
+
+}
+
+unsigned int ThreadPool::resolveThreadCount(unsigned int requested) {
+    if (requested != 0) return requested;
+    unsigned int cores = std::thread::hardware_concurrency();
+    return (cores == 0) ? 8 : cores;
+}
+
+void ThreadPool::constructFrom(unsigned int numThreads, bool pinCores) {
+
+    this->numThreads = resolveThreadCount(numThreads);
+    this->pinned = pinCores;
+
+    this->ranges = new StealRange[this->numThreads];
+    for (unsigned int t = 0; t < this->numThreads; ++t) {
+        this->ranges[t].bounds.store(0, std::memory_order_relaxed);
+    }
+
+    this->done.constructFrom(this->numThreads);
+
+    if (pinCores) {
+        this->topology.constructFrom();
+        for (unsigned int t = 0; t < this->numThreads; ++t) {
+            this->threadCores.push_back(this->topology.getCpuForThread(t, this->numThreads));
+        }
+    }
+
+    // The calling thread is thread 0, so only numThreads - 1 workers are created
+    if (pinCores) pinToCore(this->threadCores[0]);
+    for (unsigned int t = 1; t < this->numThreads; ++t) {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this, t);
+    }
+
+    return;
+
+}
+
+void ThreadPool::run(const std::function<void(unsigned int)>& body) {
+
+    if (this->numThreads == 1) {
+        body(0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->wakeMutex);
+        this->job = &body;
+        this->jobGeneration.fetch_add(1, std::memory_order_release);
+    }
+    this->wake.notify_all();
+
+    body(0);
+    this->done.arriveAndWait();
+
+    return;
+
+}
+
+void ThreadPool::workerLoop(unsigned int tId) {
+
+    if (this->pinned) pinToCore(this->threadCores[tId]);
+
+    uint64_t seen = 0;
+
+    while (true) {
+
+        // Jobs tend to come back to back (one or two per wave), so spin a little before going to sleep
+        int spins = 0;
+        while (this->jobGeneration.load(std::memory_order_acquire) == seen && spins < SPIN_BEFORE_SLEEP) {
+            if (++spins > SPIN_BEFORE_YIELD) std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->wakeMutex);
+            this->wake.wait(lock, [&] { return this->stopping || this->jobGeneration.load(std::memory_order_relaxed) != seen; });
+            if (this->jobGeneration.load(std::memory_order_relaxed) == seen) return; // Stopping, with no job left
+            seen = this->jobGeneration.load(std::memory_order_relaxed);
+        }
+
+        (*this->job)(tId);
+        this->done.arriveAndWait();
+    }
+
+}
+
+int ThreadPool::getNodeCount() const {
+    return this->pinned ? this->topology.nodeCount : 1;
+}
+
+bool ThreadPool::takeChunk(unsigned int tId, size_t* chunk) {
+
+    std::atomic<uint64_t>& own = this->ranges[tId].bounds;
+
+    while (true) {
+
+        // Own range first, from the front
+        uint64_t bounds = own.load(std::memory_order_acquire);
+        uint64_t lo = bounds & 0xFFFFFFFF;
+        uint64_t hi = bounds >> 32;
+        if (lo < hi) {
+            if (own.compare_exchange_weak(bounds, (lo + 1) | (hi << 32), std::memory_order_acq_rel)) {
+                *chunk = lo;
+                return true;
+            }
+            continue;
+        }
+
+        // Then steal from the thread with the most left
+        unsigned int victim = tId;
+        uint64_t mostLeft = 0;
+        for (unsigned int v = 0; v < this->numThreads; ++v) {
+            if (v == tId) continue;
+            uint64_t other = this->ranges[v].bounds.load(std::memory_order_relaxed);
+            uint64_t otherLo = other & 0xFFFFFFFF;
+            uint64_t otherHi = other >> 32;
+            if (otherHi > otherLo && otherHi - otherLo > mostLeft) {
+                mostLeft = otherHi - otherLo;
+                victim = v;
+            }
+        }
+        if (mostLeft == 0) return false;
+
+        // The victim keeps [lo, mid) and the thief takes [mid, hi)
+        std::atomic<uint64_t>& target = this->ranges[victim].bounds;
+        uint64_t victimBounds = target.load(std::memory_order_acquire);
+        uint64_t victimLo = victimBounds & 0xFFFFFFFF;
+        uint64_t victimHi = victimBounds >> 32;
+        if (victimLo >= victimHi) continue;
+
+        uint64_t mid = victimLo + (victimHi - victimLo) / 2;
+        if (!target.compare_exchange_strong(victimBounds, victimLo | (mid << 32), std::memory_order_acq_rel)) continue;
+
+        // Run the first stolen chunk now, the rest becomes this thread's own range (still open to stealing)
+        own.store((mid + 1) | (victimHi << 32), std::memory_order_release);
+        *chunk = mid;
+        return true;
+
+    }
+
+}
+
+void ThreadPool::pinToCore(unsigned int core) {
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) return;
+    core %= cores;
+
+#ifdef _WIN32
+    if (core < 64) SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+
+    return;
+
+}
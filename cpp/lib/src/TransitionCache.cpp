@@ -0,0 +1,385 @@
+#include "TransitionCache.h"
+#include "CopKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+// Bump whenever the file layout or the row encoding changes, so stale files are rebuilt instead of misread
+static constexpr uint32_t CACHE_VERSION = 1;
+static constexpr char CACHE_MAGIC[8] = {'C', 'R', 'T', 'R', 'A', 'N', 'S', '\0'};
+
+struct TransitionCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t k;
+    uint64_t graphHash;
+    uint64_t nodeCount;
+    uint64_t configCount;
+    uint64_t edgeCount;
+    uint64_t maxRowLength;
+    uint64_t encodedBytes;
+};
+
+static size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+TransitionCache::~TransitionCache() {
+    this->unmapFile();
+    delete[] this->ownedConfigs;
+    delete[] this->ownedHeads;
+    delete[] this->ownedData;
+}
+
+bool TransitionCache::constructFrom(const AdjacencyList* adj, const CopConfigRanker* ranker, const char* fileName,
+                                    Allocator* mem, ThreadPool* pool) {
+
+    this->k = ranker->k;
+    this->N = ranker->N;
+    this->configCount = ranker->configCount;
+    this->loadedFromDisk = false;
+
+    if (this->configCount == 0) return false;
+    if (fileName != nullptr && fileName[0] == '\0') fileName = nullptr;
+
+    uint64_t graphHash = adj->getContentHash();
+
+    // Step 1: Reuse the table from an earlier run if one matches this graph and k
+    if (fileName != nullptr && this->mapFile(fileName, graphHash)) {
+        this->loadedFromDisk = true;
+        std::cout << "Mapped transition cache " << fileName << " (" << this->mappedBytes << " bytes)\n";
+        return true;
+    }
+
+    // Step 2: Build it, and leave it behind for the next run
+    if (pool != nullptr) {
+        this->build(adj, ranker, *pool, mem);
+    } else {
+        ThreadPool localPool;
+        localPool.constructFrom(0);
+        this->build(adj, ranker, localPool, mem);
+    }
+
+    if (fileName != nullptr) {
+        std::error_code ec;
+        std::filesystem::path parent = std::filesystem::path(fileName).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+        if (this->writeFile(fileName, graphHash)) {
+            std::cout << "Wrote transition cache " << fileName << "\n";
+        } else {
+            std::cerr << "Warning: Could not write transition cache " << fileName << ". The table will be rebuilt next run.\n";
+        }
+    }
+
+    return true;
+
+}
+
+std::string TransitionCache::getDefaultPath(const char* cacheDir, const std::string& graphFile, int k) {
+    if (cacheDir == nullptr) return std::string();
+    std::string name = std::filesystem::path(graphFile).filename().string() + ".k" + std::to_string(k) + ".transitions";
+    return (std::filesystem::path(cacheDir) / name).string();
+}
+
+size_t TransitionCache::getMemoryFootprint() const {
+    size_t configBytes = (this->ownedConfigs != nullptr) ? this->configCount * this->k : 0;
+    size_t headsBytes = (this->ownedHeads != nullptr) ? (this->configCount + 1) * sizeof(size_t) : 0;
+    size_t dataBytes = (this->ownedData != nullptr) ? this->transitions.encodedBytes : 0;
+    return configBytes + headsBytes + dataBytes;
+}
+
+bool TransitionCache::mapFile(const char* fileName, uint64_t graphHash) {
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(TransitionCacheHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (base == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    this->fileHandle = file;
+    this->mappingHandle = mapping;
+    this->mappedBase = base;
+    this->mappedBytes = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(TransitionCacheHeader))) {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (base == MAP_FAILED) return false;
+
+    this->mappedBase = base;
+    this->mappedBytes = static_cast<size_t>(info.st_size);
+#endif
+
+    // Validate the header against the graph and k this run expects
+    const uint8_t* bytes = static_cast<const uint8_t*>(this->mappedBase);
+    TransitionCacheHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    size_t configsOffset = sizeof(TransitionCacheHeader);
+    size_t headsOffset = alignTo8(configsOffset + header.configCount * header.k);
+    size_t dataOffset = headsOffset + (header.configCount + 1) * sizeof(size_t);
+
+    bool valid = std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+              && header.version == CACHE_VERSION
+              && header.k == static_cast<uint32_t>(this->k)
+              && header.nodeCount == static_cast<uint64_t>(this->N)
+              && header.graphHash == graphHash
+              && header.configCount == this->configCount
+              && this->mappedBytes == dataOffset + header.encodedBytes;
+
+    if (!valid) {
+        std::cerr << "Warning: Transition cache " << fileName << " does not match this graph and k. Rebuilding it.\n";
+        this->unmapFile();
+        return false;
+    }
+
+    this->configs = bytes + configsOffset;
+    this->transitions.attach(reinterpret_cast<const size_t*>(bytes + headsOffset), bytes + dataOffset,
+                             header.configCount, header.edgeCount, header.maxRowLength);
+
+    return true;
+
+}
+
+void TransitionCache::unmapFile() {
+
+    if (this->mappedBase == nullptr) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(this->mappedBase);
+    CloseHandle(static_cast<HANDLE>(this->mappingHandle));
+    CloseHandle(static_cast<HANDLE>(this->fileHandle));
+    this->mappingHandle = nullptr;
+    this->fileHandle = nullptr;
+#else
+    munmap(this->mappedBase, this->mappedBytes);
+#endif
+
+    this->mappedBase = nullptr;
+    this->mappedBytes = 0;
+
+    return;
+
+}
+
+// Generates the sorted, deduplicated team moves of cId into moves, with the kernel compiled for this k
+template <typename Kernel>
+static void generateRow(size_t cId, int k, const uint8_t* configs, const AdjacencyList* adj, const CopConfigRanker* ranker,
+                        std::vector<size_t>& moves) {
+
+    moves.clear();
+    Kernel::forEachTeamMove(&configs[cId * k], k, *adj, *ranker, [&](size_t nextId) {
+        moves.push_back(nextId);
+    });
+
+    if constexpr (!Kernel::DISTINCT_MOVES) {
+        std::sort(moves.begin(), moves.end());
+        moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+    }
+
+    return;
+
+}
+
+// Runs body(tId, cId, moves) for every config on pool, handing out rows in batches
+// (row costs vary a lot, so the pool's work stealing balances better than fixed chunks)
+template <typename Body>
+static void forEachRowParallel(size_t configCount, ThreadPool& pool, Body&& body) {
+
+    const size_t BATCH_SIZE = 1024;
+
+    // One scratch row per thread, reused across every batch that thread runs
+    std::vector<std::vector<size_t>> scratch(pool.numThreads);
+    for (auto& moves : scratch) moves.reserve(1024);
+
+    pool.parallelFor(configCount, BATCH_SIZE, [&](unsigned int tId, size_t startId, size_t endId) {
+        std::vector<size_t>& moves = scratch[tId];
+        for (size_t cId = startId; cId < endId; ++cId) body(tId, cId, moves);
+    });
+
+    return;
+
+}
+
+void TransitionCache::build(const AdjacencyList* adj, const CopConfigRanker* ranker, ThreadPool& pool, Allocator* mem) {
+
+    int k = this->k;
+    size_t configCount = this->configCount;
+
+    std::cout << "Building transition table for " << configCount << " configurations using " << pool.numThreads << " threads...\n";
+
+    // Step 1: Configs in rank order, plus the heads array (its final size is already known)
+    uint8_t* configs = nullptr;
+    size_t* heads = nullptr;
+    if (mem != nullptr) {
+        mem->requestAlloc<uint8_t>("Transitions: Cop Configs", configCount * k, &configs);
+        mem->requestAlloc<size_t>("Transitions: Heads", configCount + 1, &heads);
+        mem->allocate();
+    } else {
+        this->ownedConfigs = new uint8_t[configCount * k];
+        this->ownedHeads = new size_t[configCount + 1];
+        configs = this->ownedConfigs;
+        heads = this->ownedHeads;
+    }
+
+    uint8_t current[MAX_COPS] = {0};
+    size_t offset = 0;
+    do {
+        std::memcpy(&configs[offset], current, k);
+        offset += k;
+    } while (nextCopConfig(current, k, this->N));
+
+    this->configs = configs;
+
+    // Step 2: Count pass. Every row's encoded size lands in heads[cId + 1]
+    // Per-thread totals sit on their own cache lines so the threads never share one
+    struct alignas(64) RowStats {
+        size_t edges = 0;
+        size_t maxRowLength = 0;
+    };
+    std::vector<RowStats> stats(pool.numThreads);
+
+    heads[0] = 0;
+    dispatchCopKernel(k, [&](auto kernel) {
+        using Kernel = decltype(kernel);
+        forEachRowParallel(configCount, pool, [&](unsigned int tId, size_t cId, std::vector<size_t>& moves) {
+            generateRow<Kernel>(cId, k, configs, adj, ranker, moves);
+            heads[cId + 1] = CompressedTransitions::encodedRowSize(moves.data(), moves.size());
+            stats[tId].edges += moves.size();
+            stats[tId].maxRowLength = std::max(stats[tId].maxRowLength, moves.size());
+        });
+    });
+
+    size_t edgeCount = 0;
+    size_t maxRowLength = 0;
+    for (const RowStats& stat : stats) {
+        edgeCount += stat.edges;
+        maxRowLength = std::max(maxRowLength, stat.maxRowLength);
+    }
+
+    // Step 3: Prefix sum turns the sizes into byte offsets, so every row knows exactly where it goes
+    for (size_t cId = 0; cId < configCount; ++cId) {
+        heads[cId + 1] += heads[cId];
+    }
+    size_t totalBytes = heads[configCount];
+
+    uint8_t* data = nullptr;
+    if (mem != nullptr) {
+        mem->requestAlloc<uint8_t>("Transitions: Edges (Encoded)", totalBytes, &data);
+        mem->allocate();
+    } else {
+        this->ownedData = new uint8_t[totalBytes];
+        data = this->ownedData;
+    }
+
+    // Step 4: Fill pass. Rows are regenerated and encoded straight into place, no per-thread buffers to stitch
+    dispatchCopKernel(k, [&](auto kernel) {
+        using Kernel = decltype(kernel);
+        forEachRowParallel(configCount, pool, [&](unsigned int, size_t cId, std::vector<size_t>& moves) {
+            generateRow<Kernel>(cId, k, configs, adj, ranker, moves);
+            CompressedTransitions::encodeRow(moves.data(), moves.size(), data + heads[cId]);
+        });
+    });
+
+    this->transitions.attach(heads, data, configCount, edgeCount, maxRowLength);
+
+    std::cout << "Transitions generated. Total edges: " << this->transitions.edgeCount
+              << " (" << totalBytes << " bytes encoded)\n";
+
+    return;
+
+}
+
+bool TransitionCache::writeFile(const char* fileName, uint64_t graphHash) const {
+
+    TransitionCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.k = static_cast<uint32_t>(this->k);
+    header.graphHash = graphHash;
+    header.nodeCount = static_cast<uint64_t>(this->N);
+    header.configCount = this->configCount;
+    header.edgeCount = this->transitions.edgeCount;
+    header.maxRowLength = this->transitions.maxRowLength;
+    header.encodedBytes = this->transitions.encodedBytes;
+
+    size_t configBytes = this->configCount * this->k;
+    size_t padding = alignTo8(sizeof(header) + configBytes) - (sizeof(header) + configBytes);
+    const char zeros[8] = {0};
+
+    // A unique temporary name, in case another process is writing the same cache at the same time
+    std::string tempName = std::string(fileName) + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(this->configs), configBytes);
+        out.write(zeros, padding);
+        out.write(reinterpret_cast<const char*>(this->transitions.getHeads()), (this->configCount + 1) * sizeof(size_t));
+        out.write(reinterpret_cast<const char*>(this->transitions.getData()), this->transitions.encodedBytes);
+
+        if (!out.good()) {
+            out.close();
+            std::remove(tempName.c_str());
+            return false;
+        }
+    }
+
+    // Renaming is atomic on POSIX. Windows refuses to rename over an existing file, so clear it first
+#ifdef _WIN32
+    std::remove(fileName);
+#endif
+    if (std::rename(tempName.c_str(), fileName) != 0) {
+        std::remove(tempName.c_str());
+        return false;
+    }
+
+    return true;
+
+}
@@ -0,0 +1,192 @@
+#include "TransitionProvider.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+
+
+void TransitionProvider::constructFrom(const AdjacencyList* adj, const CopConfigRanker* ranker, size_t budgetBytes,
+                                       ThreadPool& pool) {
+
+    this->adj = adj;
+    this->ranker = ranker;
+    this->k = ranker->k;
+    this->N = ranker->N;
+    this->configCount = ranker->configCount;
+    this->budgetBytes = budgetBytes;
+    this->cachedRows = 0;
+    this->cachedEdges = 0;
+
+    this->rowIndex.clear();
+    this->rowHeads.clear();
+    this->rowData.clear();
+    this->rows = CompressedTransitions();
+
+    // The index alone has to fit before any row can be cached
+    size_t indexBytes = this->configCount * sizeof(uint32_t);
+    if (budgetBytes <= indexBytes || this->configCount >= NOT_CACHED) return;
+
+    // Configs are handed to the threads in ranges of this many (row costs vary a lot, so the pool's work stealing
+    // balances better than one fixed chunk per thread)
+    const size_t RANGE_CONFIGS = 1024;
+    size_t rangeCount = (this->configCount + RANGE_CONFIGS - 1) / RANGE_CONFIGS;
+
+    dispatchCopKernel(this->k, [&](auto kernel) {
+        using Kernel = decltype(kernel);
+
+        // Step 1: Histogram of Cartesian product sizes (only a handful of distinct values on real graphs)
+        // Every thread counts into its own map, and the maps are merged afterwards
+        using ProductCounts = std::map<uint64_t, size_t, std::greater<uint64_t>>;
+        std::vector<ProductCounts> threadCounts(pool.numThreads);
+        pool.parallelFor(this->configCount, RANGE_CONFIGS, [&](unsigned int tId, size_t startId, size_t endId) {
+            uint8_t currentCops[MAX_COPS];
+            for (size_t cId = startId; cId < endId; ++cId) {
+                this->ranker->unrank(cId, currentCops);
+                threadCounts[tId][Kernel::countTeamMoves(currentCops, this->k, *this->adj)]++;
+            }
+        });
+
+        ProductCounts productCounts;
+        for (const ProductCounts& counts : threadCounts) {
+            for (const auto& entry : counts) productCounts[entry.first] += entry.second;
+        }
+
+        // Step 2: Walk the products from largest down, and stop where the estimated rows overflow the budget
+        // Rows average well under 2 bytes per generated move once deduplicated and delta encoded, plus 8 bytes of head
+        size_t rowBudget = budgetBytes - indexBytes;
+        size_t estimate = 0;
+        size_t expectedRows = 0;
+        uint64_t threshold = UINT64_MAX;
+        for (const auto& entry : productCounts) {
+            size_t bytes = entry.second * (sizeof(size_t) + 2 * entry.first);
+            if (estimate + bytes > rowBudget) break;
+            estimate += bytes;
+            expectedRows += entry.second;
+            threshold = entry.first;
+        }
+        if (threshold == UINT64_MAX) return;
+
+        // Fills moves with the sorted row of cId. Returns false (moves untouched) for a row below the threshold
+        auto generateRow = [&](size_t cId, uint8_t* currentCops, std::vector<size_t>& moves) {
+            this->ranker->unrank(cId, currentCops);
+            if (Kernel::countTeamMoves(currentCops, this->k, *this->adj) < threshold) return false;
+
+            moves.clear();
+            Kernel::forEachTeamMove(currentCops, this->k, *this->adj, *this->ranker, [&](size_t nextId) {
+                moves.push_back(nextId);
+            });
+
+            if constexpr (!Kernel::DISTINCT_MOVES) {
+                std::sort(moves.begin(), moves.end());
+                moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+            }
+            return true;
+        };
+
+        // One scratch row per thread, reused across every range that thread runs
+        std::vector<std::vector<size_t>> scratch(pool.numThreads);
+
+        // Step 3: Size every row at or above the threshold exactly, summed per range
+        std::vector<size_t> rangeRows(rangeCount + 1, 0);
+        std::vector<size_t> rangeBytes(rangeCount + 1, 0);
+        pool.parallelFor(rangeCount, 1, [&](unsigned int tId, size_t startRange, size_t endRange) {
+            uint8_t currentCops[MAX_COPS];
+            for (size_t range = startRange; range < endRange; ++range) {
+                size_t endId = std::min((range + 1) * RANGE_CONFIGS, this->configCount);
+                for (size_t cId = range * RANGE_CONFIGS; cId < endId; ++cId) {
+                    if (!generateRow(cId, currentCops, scratch[tId])) continue;
+                    rangeRows[range + 1]++;
+                    rangeBytes[range + 1] += CompressedTransitions::encodedRowSize(scratch[tId].data(), scratch[tId].size());
+                }
+            }
+        });
+
+        // Prefix sums place every range, in config order, and find the first one whose rows overflow what the
+        // heads leave over. Only that range is walked again, one row at a time, to find the exact cutoff
+        size_t dataBudget = rowBudget - (expectedRows + 1) * sizeof(size_t);
+        size_t endConfig = this->configCount;
+        size_t cutRange = rangeCount;
+        for (size_t range = 0; range < rangeCount; ++range) {
+            if (rangeBytes[range] + rangeBytes[range + 1] > dataBudget) {
+                cutRange = range;
+                break;
+            }
+            rangeRows[range + 1] += rangeRows[range];
+            rangeBytes[range + 1] += rangeBytes[range];
+        }
+
+        size_t keptRows = rangeRows[cutRange];
+        size_t keptBytes = rangeBytes[cutRange];
+        if (cutRange < rangeCount) {
+            std::cerr << "Warning: Transition cache budget reached early, remaining rows are generated on the fly.\n";
+
+            uint8_t currentCops[MAX_COPS];
+            endConfig = cutRange * RANGE_CONFIGS;
+            size_t endId = std::min(endConfig + RANGE_CONFIGS, this->configCount);
+            for (; endConfig < endId; ++endConfig) {
+                if (!generateRow(endConfig, currentCops, scratch[0])) continue;
+
+                size_t bytes = CompressedTransitions::encodedRowSize(scratch[0].data(), scratch[0].size());
+                if (keptBytes + bytes > dataBudget) break;
+                keptRows++;
+                keptBytes += bytes;
+            }
+        }
+
+        // Step 4: Encode the kept rows in parallel, each range straight into its place in storage reserved at exactly
+        // the size of the rows (so the table never reallocates, nor passes the budget on the way)
+        this->rowIndex.assign(this->configCount, NOT_CACHED);
+        this->rowHeads.resize(keptRows + 1);
+        this->rowData.resize(keptBytes);
+
+        // Per-thread totals sit on their own cache lines so the threads never share one
+        struct alignas(64) RowStats {
+            size_t edges = 0;
+            size_t maxRowLength = 0;
+        };
+        std::vector<RowStats> stats(pool.numThreads);
+
+        size_t encodeRanges = std::min(cutRange + 1, rangeCount);
+        pool.parallelFor(encodeRanges, 1, [&](unsigned int tId, size_t startRange, size_t endRange) {
+            uint8_t currentCops[MAX_COPS];
+            std::vector<size_t>& moves = scratch[tId];
+            for (size_t range = startRange; range < endRange; ++range) {
+                size_t row = rangeRows[range];
+                size_t offset = rangeBytes[range];
+                size_t endId = std::min((range + 1) * RANGE_CONFIGS, endConfig);
+                for (size_t cId = range * RANGE_CONFIGS; cId < endId; ++cId) {
+                    if (!generateRow(cId, currentCops, moves)) continue;
+
+                    this->rowIndex[cId] = static_cast<uint32_t>(row);
+                    this->rowHeads[row++] = offset;
+                    CompressedTransitions::encodeRow(moves.data(), moves.size(), this->rowData.data() + offset);
+                    offset += CompressedTransitions::encodedRowSize(moves.data(), moves.size());
+
+                    stats[tId].edges += moves.size();
+                    stats[tId].maxRowLength = std::max(stats[tId].maxRowLength, moves.size());
+                }
+            }
+        });
+        this->rowHeads[keptRows] = keptBytes;
+
+        size_t edgeCount = 0;
+        size_t maxRowLength = 0;
+        for (const RowStats& stat : stats) {
+            edgeCount += stat.edges;
+            maxRowLength = std::max(maxRowLength, stat.maxRowLength);
+        }
+
+        this->rows.attach(this->rowHeads.data(), this->rowData.data(), keptRows, edgeCount, maxRowLength);
+    });
+
+    this->cachedRows = this->rows.rowCount;
+    this->cachedEdges = this->rows.edgeCount;
+
+    return;
+
+}
+
+size_t TransitionProvider::getMemoryFootprint() const {
+    return this->rowIndex.capacity() * sizeof(uint32_t) + this->rowHeads.capacity() * sizeof(size_t) + this->rowData.capacity();
+}
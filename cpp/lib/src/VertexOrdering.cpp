@@ -0,0 +1,194 @@
+#include "VertexOrdering.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+
+// Breadth-first search from start over the nodes not yet placed. Appends the nodes it reaches to outOrder, queueing
+// each node's neighbours by ascending degree if byDegree (ties and everything else by label)
+// Returns the number of BFS levels, and writes the index into outOrder where the last one begins to lastLevelStart
+static int appendBfs(const Graph* g, int start, const std::vector<int>& degree, bool byDegree,
+                     std::vector<bool>& placed, std::vector<int>& outOrder, size_t* lastLevelStart) {
+
+    int N = g->nodeCount;
+    size_t head = outOrder.size();
+    size_t levelStart = head;
+    size_t levelEnd = head + 1;
+    int levels = 1;
+
+    outOrder.push_back(start);
+    placed[start] = true;
+
+    std::vector<int> neighbours;
+
+    while (head < outOrder.size()) {
+        if (head == levelEnd) {
+            levelStart = levelEnd;
+            levelEnd = outOrder.size();
+            levels++;
+        }
+
+        int u = outOrder[head++];
+
+        neighbours.clear();
+        for (int v = 0; v < N; ++v) {
+            if (!placed[v] && g->getEdge(u, v)) neighbours.push_back(v);
+        }
+        if (byDegree) {
+            std::stable_sort(neighbours.begin(), neighbours.end(), [&](int a, int b) { return degree[a] < degree[b]; });
+        }
+
+        for (int v : neighbours) {
+            placed[v] = true;
+            outOrder.push_back(v);
+        }
+    }
+
+    *lastLevelStart = levelStart;
+    return levels;
+
+}
+
+// Largest label distance across an edge, with node v carrying the label labelOf[v]
+static int getBandwidth(const Graph* g, const int* labelOf) {
+
+    int bandwidth = 0;
+    for (int u = 0; u < g->nodeCount; ++u) {
+        for (int v = u + 1; v < g->nodeCount; ++v) {
+            if (g->getEdge(u, v)) bandwidth = std::max(bandwidth, std::abs(labelOf[u] - labelOf[v]));
+        }
+    }
+
+    return bandwidth;
+
+}
+
+VertexOrdering::~VertexOrdering() {
+    delete[] this->newToOld;
+    delete[] this->oldToNew;
+}
+
+void VertexOrdering::constructFrom(const Graph* g, Method method) {
+
+    int N = g->nodeCount;
+
+    delete[] this->newToOld;
+    delete[] this->oldToNew;
+
+    this->nodeCount = N;
+    this->method = method;
+    this->newToOld = new int[N];
+    this->oldToNew = new int[N];
+
+    std::vector<int> order;
+    order.reserve(N);
+
+    if (method == Method::ORIGINAL) {
+        for (int v = 0; v < N; ++v) order.push_back(v);
+    } else {
+
+        std::vector<int> degree(N, 0);
+        for (int u = 0; u < N; ++u) {
+            for (int v = 0; v < N; ++v) {
+                if (g->getEdge(u, v)) degree[u]++;
+            }
+        }
+
+        bool byDegree = (method == Method::RCM);
+        std::vector<bool> placed(N, false);
+        std::vector<bool> scratch(N, false);
+        std::vector<int> probe;
+
+        // One component at a time, each starting from its lowest degree node that has not been placed
+        while (static_cast<int>(order.size()) < N) {
+            int start = -1;
+            for (int v = 0; v < N; ++v) {
+                if (!placed[v] && (start == -1 || degree[v] < degree[start])) start = v;
+            }
+
+            // Walk out to a pseudo-peripheral node (George-Liu): move to the lowest degree node of the last BFS
+            // level for as long as the BFS from there is deeper
+            size_t lastLevel;
+            scratch = placed;
+            probe.clear();
+            int levels = appendBfs(g, start, degree, byDegree, scratch, probe, &lastLevel);
+
+            while (true) {
+                int next = probe[lastLevel];
+                for (size_t i = lastLevel; i < probe.size(); ++i) {
+                    if (degree[probe[i]] < degree[next]) next = probe[i];
+                }
+
+                scratch = placed;
+                probe.clear();
+                int nextLevels = appendBfs(g, next, degree, byDegree, scratch, probe, &lastLevel);
+                if (nextLevels <= levels) break;
+
+                start = next;
+                levels = nextLevels;
+            }
+
+            size_t unused;
+            appendBfs(g, start, degree, byDegree, placed, order, &unused);
+        }
+
+        if (method == Method::RCM) std::reverse(order.begin(), order.end());
+    }
+
+    for (int i = 0; i < N; ++i) {
+        this->newToOld[i] = order[i];
+        this->oldToNew[order[i]] = i;
+    }
+
+    std::vector<int> identity(N);
+    for (int v = 0; v < N; ++v) identity[v] = v;
+    this->bandwidthBefore = getBandwidth(g, identity.data());
+    this->bandwidthAfter = getBandwidth(g, this->oldToNew);
+
+    return;
+
+}
+
+void VertexOrdering::apply(Graph* g) const {
+    g->relabel(this->newToOld);
+}
+
+void VertexOrdering::configToOriginal(const uint8_t* config, int k, uint8_t* outConfig) const {
+
+    for (int i = 0; i < k; ++i) {
+        outConfig[i] = static_cast<uint8_t>(this->newToOld[config[i]]);
+    }
+    std::sort(outConfig, outConfig + k);
+
+    return;
+
+}
+
+std::string VertexOrdering::getCacheSuffix() const {
+    if (this->method == Method::ORIGINAL) return "";
+    return std::string(".") + this->getMethodName();
+}
+
+const char* VertexOrdering::getMethodName() const {
+    switch (this->method) {
+        case Method::BFS: return "bfs";
+        case Method::RCM: return "rcm";
+        default: return "original";
+    }
+}
+
+bool VertexOrdering::parseMethod(const std::string& name, Method* outMethod) {
+
+    if (name == "original") *outMethod = Method::ORIGINAL;
+    else if (name == "bfs") *outMethod = Method::BFS;
+    else if (name == "rcm") *outMethod = Method::RCM;
+    else return false;
+
+    return true;
+
+}
+
+size_t VertexOrdering::getMemoryFootprint() const {
+    return sizeof(*this) + 2 * this->nodeCount * sizeof(int);
+}
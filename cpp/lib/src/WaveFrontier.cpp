@@ -0,0 +1,189 @@
+#include "WaveFrontier.h"
+
+#include <utility>
+#include <vector>
+
+
+// advance() splits the planes into runs of this many blocks, each counted and compacted as one unit
+static constexpr size_t ADVANCE_CHUNK_BLOCKS = 4096;
+
+void WaveFrontier::constructFrom(size_t numStates, Allocator* mem, Allocator::Placement placement) {
+
+    this->numStates = numStates;
+    this->waveSize = 0;
+    this->robberTurnSize = 0;
+    this->dense = false;
+
+    this->planeWords = (numStates + 63) / 64;
+    this->listAllowed = (numStates <= ((size_t)1 << 31));
+
+    // A buffer holds two planes (or a list in state order), so an even split would not follow the state ranges
+    // Partitioned requests interleave instead
+    if (placement == Allocator::Placement::PARTITIONED) placement = Allocator::Placement::INTERLEAVE;
+
+    mem->requestAlloc("Frontier Buffer A (2 bits)", 2 * this->planeWords, &this->current, placement);
+    mem->requestAlloc("Frontier Buffer B (2 bits)", 2 * this->planeWords, &this->next, placement);
+    // Both buffers start empty: Allocator memory is zeroed, and an atomic word is a plain word (see PackedStateStore)
+    mem->allocate();
+
+    return;
+
+}
+
+size_t WaveFrontier::advance(ThreadPool& pool) {
+
+    std::atomic<uint64_t>* filled = this->next;
+    std::atomic<uint64_t>* spare = this->current;
+
+    // Chunk c covers the blocks [c * ADVANCE_CHUNK_BLOCKS, (c + 1) * ADVANCE_CHUNK_BLOCKS) in both planes
+    // Chunks are fixed (not per thread), so the list offsets below do not depend on which thread ran which chunk
+    size_t chunkCount = (this->planeWords + ADVANCE_CHUNK_BLOCKS - 1) / ADVANCE_CHUNK_BLOCKS;
+
+    auto chunkBounds = [&](size_t chunk, size_t* begin, size_t* end) {
+        *begin = chunk * ADVANCE_CHUNK_BLOCKS;
+        *end = *begin + ADVANCE_CHUNK_BLOCKS;
+        if (*end > this->planeWords) *end = this->planeWords;
+    };
+
+    // PASS 1 --- Count the new wave
+    std::vector<size_t> chunkSizes(chunkCount, 0);
+    std::vector<size_t> chunkRobberSizes(chunkCount, 0);
+    pool.parallelFor(chunkCount, 1, [&](unsigned int, size_t chunk, size_t) {
+        size_t begin, end;
+        chunkBounds(chunk, &begin, &end);
+        size_t copCount = 0;
+        size_t robberCount = 0;
+        for (size_t block = begin; block < end; ++block) {
+            copCount += __builtin_popcountll(filled[block].load(std::memory_order_relaxed));
+            robberCount += __builtin_popcountll(filled[this->planeWords + block].load(std::memory_order_relaxed));
+        }
+        chunkSizes[chunk] = copCount + robberCount;
+        chunkRobberSizes[chunk] = robberCount;
+    });
+
+    size_t newSize = 0;
+    size_t newRobberTurnSize = 0;
+    std::vector<size_t> chunkOffsets(chunkCount, 0);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        chunkOffsets[i] = newSize;
+        newSize += chunkSizes[i];
+        newRobberTurnSize += chunkRobberSizes[i];
+    }
+
+    // A list of 32-bit entries is smaller than the 2 * numStates bit bitmap below 4 entries per plane word
+    bool keepList = this->listAllowed && (newSize < 4 * this->planeWords);
+
+    if (!keepList) {
+
+        // The spare buffer takes the next wave. A dense wave cleared itself as it was visited, a list did not
+        if (!this->dense) {
+            size_t listWords = (this->waveSize + 1) / 2;
+            for (size_t w = 0; w < listWords; ++w) {
+                spare[w].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        this->current = filled;
+        this->next = spare;
+        this->dense = true;
+        this->waveSize = newSize;
+        this->robberTurnSize = newRobberTurnSize;
+        return newSize;
+
+    }
+
+    // PASS 2 --- Compact the bitmap into a list in the spare buffer, clearing the bitmap as it goes
+    // Entries are packed two to a word. A word two chunks share is zeroed up front and filled with fetch_or,
+    // every other word is written whole
+    for (size_t i = 0; i < chunkCount; ++i) {
+        spare[chunkOffsets[i] >> 1].store(0, std::memory_order_relaxed);
+    }
+    spare[newSize >> 1].store(0, std::memory_order_relaxed);
+
+    // A longer list from the last wave leaves a tail past the new one, which has to be empty for a later bitmap
+    if (!this->dense) {
+        size_t oldListWords = (this->waveSize + 1) / 2;
+        for (size_t w = (newSize + 1) / 2; w < oldListWords; ++w) {
+            spare[w].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    pool.parallelFor(chunkCount, 1, [&](unsigned int, size_t chunk, size_t) {
+        size_t begin, end;
+        chunkBounds(chunk, &begin, &end);
+
+        size_t index = chunkOffsets[chunk];
+        bool havePending = false;
+        uint64_t pending = 0;
+
+        for (size_t block = begin; block < end; ++block) {
+            for (int turn = 0; turn < 2; ++turn) {
+                std::atomic<uint64_t>& word = filled[turn * this->planeWords + block];
+                uint64_t bits = word.load(std::memory_order_relaxed);
+                if (bits == 0) continue;
+                word.store(0, std::memory_order_relaxed);
+
+                while (bits != 0) {
+                    uint64_t entry = ((block * 64 + __builtin_ctzll(bits)) << 1) | static_cast<uint64_t>(turn);
+                    bits &= bits - 1;
+
+                    if ((index & 1) == 0) {
+                        pending = entry;
+                        havePending = true;
+                    } else if (havePending) {
+                        spare[index >> 1].store(pending | (entry << 32), std::memory_order_relaxed);
+                        havePending = false;
+                    } else {
+                        spare[index >> 1].fetch_or(entry << 32, std::memory_order_relaxed);
+                    }
+                    index++;
+                }
+            }
+        }
+
+        if (havePending) {
+            spare[(index - 1) >> 1].fetch_or(pending, std::memory_order_relaxed);
+        }
+    });
+
+    // The list stays in the buffer the old wave used, and the cleared bitmap takes the next wave
+    this->dense = false;
+    this->waveSize = newSize;
+    this->robberTurnSize = newRobberTurnSize;
+    return newSize;
+
+}
+
+void WaveFrontier::discard() {
+
+    // A list is cleaned up by the next advance(), only an unvisited bitmap is left to clear
+    if (this->dense) {
+        for (size_t i = 0; i < 2 * this->planeWords; ++i) {
+            this->current[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    return;
+
+}
+
+int WaveFrontier::getCurrentBuffer() const {
+    // Both buffers come from one arena, A requested first, so A is the lower address
+    return (this->current < this->next) ? 0 : 1;
+}
+
+void WaveFrontier::restore(size_t waveSize, size_t robberTurnSize, bool dense, int currentBuffer) {
+
+    if (this->getCurrentBuffer() != currentBuffer) std::swap(this->current, this->next);
+
+    this->waveSize = waveSize;
+    this->robberTurnSize = robberTurnSize;
+    this->dense = dense;
+
+    return;
+
+}
+
+size_t WaveFrontier::getMemoryFootprint() const {
+    return 4 * this->planeWords * sizeof(uint64_t);
+}
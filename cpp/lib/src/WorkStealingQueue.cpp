@@ -0,0 +1,57 @@
+#include "WorkStealingQueue.h"
+
+
+WorkStealingQueue::~WorkStealingQueue() {
+    for (Ring* r : this->rings) {
+        delete[] r->slots;
+        delete r;
+    }
+}
+
+void WorkStealingQueue::constructFrom(size_t initialCapacity) {
+
+    int64_t capacity = 1;
+    while (capacity < static_cast<int64_t>(initialCapacity)) capacity <<= 1;
+
+    Ring* r = new Ring;
+    r->capacity = capacity;
+    r->mask = capacity - 1;
+    r->slots = new std::atomic<uint64_t>[capacity];
+
+    this->rings.push_back(r);
+    this->top.store(0, std::memory_order_relaxed);
+    this->bottom.store(0, std::memory_order_relaxed);
+    this->ring.store(r, std::memory_order_release);
+
+    return;
+
+}
+
+WorkStealingQueue::Ring* WorkStealingQueue::grow(int64_t t, int64_t b) {
+
+    Ring* oldRing = this->ring.load(std::memory_order_relaxed);
+
+    Ring* r = new Ring;
+    r->capacity = oldRing->capacity * 2;
+    r->mask = r->capacity - 1;
+    r->slots = new std::atomic<uint64_t>[r->capacity];
+
+    // Items keep their indices, so a thief holding top stays valid in either ring
+    for (int64_t i = t; i < b; ++i) {
+        r->slots[i & r->mask].store(oldRing->slots[i & oldRing->mask].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    this->rings.push_back(r);
+    this->ring.store(r, std::memory_order_release);
+
+    return r;
+
+}
+
+size_t WorkStealingQueue::getMemoryFootprint() const {
+    size_t bytes = 0;
+    for (const Ring* r : this->rings) {
+        bytes += static_cast<size_t>(r->capacity) * sizeof(uint64_t);
+    }
+    return bytes;
+}
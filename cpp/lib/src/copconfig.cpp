@@ -0,0 +1,163 @@
+#include "copconfig.h"
+
+#include <cstring>
+#include <iostream>
+
+
+size_t countCopConfigs(int k, int N) {
+
+    // Combinations with replacement: C(N + k - 1, k)
+    int n_val = N + k - 1;
+    int k_val = k;
+
+    if (k_val < 0 || k_val > n_val) return 0;
+    if (k_val == 0 || k_val == n_val) return 1;
+
+    if (k_val > n_val / 2) k_val = n_val - k_val;
+    size_t res = 1;
+    for (int i = 1; i <= k_val; ++i) {
+        res = res * (n_val - i + 1) / i;
+    }
+
+    return res;
+
+}
+
+bool nextCopConfig(uint8_t* config, int k, int N) {
+
+    // Find the rightmost element that can be incremented
+    int p = k - 1;
+    while (p >= 0 && config[p] == N - 1) {
+        p--;
+    }
+
+    // If all elements are N-1, we are done
+    if (p < 0) return false;
+
+    config[p]++;
+
+    // Set all subsequent elements to match this new value (maintaining sorted order)
+    for (int i = p + 1; i < k; ++i) {
+        config[i] = config[p];
+    }
+
+    return true;
+
+}
+
+uint8_t* generateCopConfigs(uint32_t k, int N, size_t* outNumConfigs) {
+
+    // Failsafe for stack array size
+    if (k == 0 || k > MAX_COPS) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        *outNumConfigs = 0;
+        return nullptr;
+    }
+
+    // 1. Calculate exact state space size
+    *outNumConfigs = countCopConfigs(k, N);
+    if (*outNumConfigs == 0) return nullptr;
+
+    // 2. Allocate exact flat array
+    size_t totalBytes = (*outNumConfigs) * k;
+    uint8_t* configs = new uint8_t[totalBytes];
+
+    // 3. Initialize the first configuration on the stack: [0, 0, ..., 0]
+    uint8_t current[MAX_COPS];
+    std::memset(current, 0, MAX_COPS);
+
+    size_t offset = 0;
+
+    // 4. Iteratively generate the next lexicographical combination
+    do {
+        std::memcpy(&(configs[offset]), current, k);
+        offset += k;
+    } while (nextCopConfig(current, k, N));
+
+    return configs;
+
+}
+
+
+CopConfigRanker::CopConfigRanker(int k, int N) : k(0), N(0), configCount(0), weights(nullptr), suffixCounts(nullptr) {
+
+    this->constructFrom(k, N);
+
+    return;
+
+}
+
+CopConfigRanker::~CopConfigRanker() {
+    delete[] this->weights;
+    delete[] this->suffixCounts;
+}
+
+void CopConfigRanker::constructFrom(int k, int N) {
+
+    delete[] this->weights;
+    delete[] this->suffixCounts;
+
+    this->k = k;
+    this->N = N;
+    this->configCount = countCopConfigs(k, N);
+
+    // Step 1: Suffix multiset counts, S(j, a) = S(j, a + 1) + S(j - 1, a)
+    // Either the smallest element is a (leaving j - 1 elements from [a, N)), or every element is above a
+    int stride = N + 1;
+    this->suffixCounts = new size_t[(k + 1) * stride];
+
+    for (int a = 0; a <= N; ++a) {
+        this->suffixCounts[a] = 1;
+    }
+    for (int j = 1; j <= k; ++j) {
+        size_t* row = &this->suffixCounts[j * stride];
+        const size_t* prevRow = &this->suffixCounts[(j - 1) * stride];
+        row[N] = 0;
+        for (int a = N - 1; a >= 0; --a) {
+            row[a] = row[a + 1] + prevRow[a];
+        }
+    }
+
+    // Step 2: Per-slot rank weights
+    // Configs ranked below c = sum over slots i of (configs whose slot i lies in [c[i-1], c[i]) with the same prefix)
+    // Telescoping that sum leaves configCount plus one independent term per slot, stored here
+    this->weights = new size_t[k * N];
+
+    for (int i = 0; i < k; ++i) {
+        const size_t* sameSlot = &this->suffixCounts[(k - i) * stride];
+        const size_t* nextSlot = &this->suffixCounts[(k - i - 1) * stride];
+        for (int v = 0; v < N; ++v) {
+            size_t carried = (i < k - 1) ? nextSlot[v] : 0;
+            this->weights[i * N + v] = carried - sameSlot[v];
+        }
+    }
+
+    return;
+
+}
+
+void CopConfigRanker::unrank(size_t cId, uint8_t* outConfig) const {
+
+    int stride = this->N + 1;
+    int v = 0;
+
+    for (int i = 0; i < this->k; ++i) {
+
+        // Number of configs sharing this prefix with slot i fixed to v
+        const size_t* remaining = &this->suffixCounts[(this->k - i - 1) * stride];
+
+        while (cId >= remaining[v]) {
+            cId -= remaining[v];
+            v++;
+        }
+
+        outConfig[i] = static_cast<uint8_t>(v);
+    }
+
+    return;
+
+}
+
+size_t CopConfigRanker::getMemoryFootprint() const {
+    return sizeof(*this) + (this->k * this->N + (this->k + 1) * (this->N + 1)) * sizeof(size_t);
+}
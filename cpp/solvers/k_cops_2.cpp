@@ -6,20 +6,23 @@
  * Solves the Cops and Robbers graph game with improved performance and reduced 
  * overhead. It does this using (A) exact combinatorial calculation and iterative 
  * state generation, (B) a flat Compressed Sparse Row (CSR) format for transition 
- * lookup, and (C) direct pointer arithmetic and caching in the induction loop.
+ * lookup, and (C) an induction loop that reaches states through the table's 
+ * layout accessors, so the memory layout can be swapped without touching it.
  * * DEEPER DIVE
  * - STL Removal: `std::vector` overhead is largely eliminated in favor of 
  * contiguous `uint8_t` arrays, drastically reducing fragmentation and 
  * improving cache locality.
  * - Exact Allocation: Instead of dynamic resizing, the state space size is 
  * pre-calculated using combinations with replacement. Memory is allocated upfront.
- * - CSR Transitions: Team moves are packed into `transitionHeads` and 
- * `transitions`. Instead of chasing pointers in a vector-of-vectors, the cops' 
- * moves for configuration `cId` are found sequentially between 
- * `transitionHeads[cId]` and `transitionHeads[cId + 1]`.
- * - Loop Optimization: The backward induction loop caches `cId * N` and utilizes 
- * pointer striding (`rEdges += adj.maxDegree`) to evaluate the robber's moves 
- * without redundant multiplication or array indexing.
+ * - CSR Transitions: Team moves are packed into a `CompressedTransitions` table. 
+ * Instead of chasing pointers in a vector-of-vectors, the cops' moves for 
+ * configuration `cId` are a single delta + varint encoded row, decoded once per 
+ * `cId` into a small buffer and reused for every robber position. With 
+ * `--transition-cache [dir]` the table is written to dir on the first run and 
+ * memory mapped afterwards.
+ * - State Layout (`--layout config|robber|blocked`): States are reached through 
+ * AuxGraph's layout accessors, so the same sweep can run over a config-major, 
+ * robber-major or tiled (`--block-configs B`) table for comparison.
 
 EXAMPLE RUN (scotlandyard-all with 3 cops)
 ||>>>>>=====-----=====<<<<<     Memory Tracking Report     >>>>>=====-----=====<<<<<
@@ -85,7 +88,8 @@ struct DataItem {
 };
 
 // --- MAIN ALGORITHM ---
-void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
+template <typename Layout>
+void solveCopsAndRobbers(const char* filename, int k, const Layout& layout, const char* cacheDir, Profiler* p) {
 
     Allocator mem;
 
@@ -110,11 +114,14 @@ void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
 
 
     /* --- Build Aux Graph --- */
-    AuxGraph<DataItem> aux;
+    AuxGraph<DataItem, Layout> aux;
     {
         p->enter("Build Aux Graph");
 
-        aux.constructFrom(k, &adj, &mem);
+        aux.layout = layout;
+
+        std::string cacheFile = TransitionCache::getDefaultPath(cacheDir, filename, k);
+        aux.constructFrom(k, &adj, &mem, cacheFile.c_str());
         if (aux.configCount == 0) {
             std::cerr << "Error: Unable to generate aux graph.\n";
             return;
@@ -160,7 +167,8 @@ void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
         // Loop variables
         int passes = 0;
         int newWinsThisPass;
-        size_t copTransStart; size_t copTransEnd;
+        size_t copTransCount;
+        std::vector<size_t> copTrans(aux.table.transitions.maxRowLength);
         DataItem* state;
         DataItem* nextState;
         uint8_t* rEdges;
@@ -178,7 +186,7 @@ void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
 
             for (cId = 0; cId < aux.configCount; ++cId) {
                 
-                aux.getCopTransitions(cId, copTransStart, copTransEnd);
+                copTransCount = aux.decodeCopTransitions(cId, copTrans.data());
                 universalWinForCId = true;
                 
                 for (r = 0; r < adj.nodeCount; ++r) {
@@ -206,8 +214,8 @@ void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
 
                     // --- LEFT SIDE: Cop's Turn ---
                     if (!state->copTurnWins) {
-                        for (i = copTransStart; i < copTransEnd; ++i) {
-                            nextState = &(aux.states[aux.transitions[i] + r]);
+                        for (i = 0; i < copTransCount; ++i) {
+                            nextState = aux.getState(copTrans[i], r);
                             if (nextState->robberTurnWins) {
                                 state->copTurnWins = 1;
                                 newWinsThisPass++;
@@ -257,6 +265,7 @@ void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
                 std::cout << (int)aux.configs[winningStartConfigId * k + i] << (i == k - 1 ? "" : ", ");
             }
             std::cout << ")\n";
+            std::cout << "(Found on pass " << captureRounds << " of the backward induction)\n";
         } else {
             std::cout << "RESULT: LOSS. " << k << " Cop(s) CANNOT guarantee a win.\n";
             std::cout << "(The Robber has a strategy to survive indefinitely against any start).\n";
@@ -279,16 +288,48 @@ int main(int argc, char* argv[]) {
     
     Profiler p;
 
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+    std::string layoutName = "config";
+    size_t blockConfigs = 64;
+    const char* cacheDir = nullptr;
+    bool badArgs = (argc < 3);
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--layout" && i + 1 < argc) {
+            layoutName = argv[++i];
+            badArgs = (layoutName != "config" && layoutName != "robber" && layoutName != "blocked");
+        } else if (arg == "--block-configs" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            blockConfigs = std::stoull(argv[++i]);
+            badArgs = (blockConfigs == 0 || (blockConfigs & (blockConfigs - 1)) != 0);
+        } else if (arg == "--transition-cache") {
+            cacheDir = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) ? argv[++i] : "transition_cache";
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [--layout config|robber|blocked] [--block-configs B] [--transition-cache [d]]\n";
         std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        std::cout << "  --layout          state table order: cId * N + r (default), r * configs + cId, or tiles\n";
+        std::cout << "  --block-configs B configs per tile of the blocked layout, a power of two (default: 64)\n";
+        std::cout << "  --transition-cache [d] keep the transition table in directory d for later runs (default: transition_cache)\n";
         return 1;
     }
 
     const char* filename = argv[1];
     int k = std::stoi(argv[2]);
     
-    solveCopsAndRobbers(filename, k, &p);
+    if (layoutName == "robber") {
+        solveCopsAndRobbers(filename, k, RobberMajorLayout(), cacheDir, &p);
+    } else if (layoutName == "blocked") {
+        BlockedLayout layout;
+        layout.blockConfigs = blockConfigs;
+        solveCopsAndRobbers(filename, k, layout, cacheDir, &p);
+    } else {
+        solveCopsAndRobbers(filename, k, ConfigMajorLayout(), cacheDir, &p);
+    }
 
     p.print();
 
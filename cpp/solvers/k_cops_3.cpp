@@ -13,9 +13,18 @@
  * - Bit-Packing: The work queue tracks both the `stateId` and whose turn it is. 
  * The Most Significant Bit (MSB) of the `size_t` is hijacked to flag if it is 
  * the Robber's turn (1) or the Cop's turn (0).
+ * - Locality-Ordered Levels: The queue is still FIFO, but each BFS level is 
+ * bucketed by state ID (an in-place American flag sort on the top bits) before 
+ * it is processed, so consecutive entries touch neighbouring states and rows 
+ * instead of wherever they were discovered. Order within a level does not 
+ * change the result.
  * - AuxGraph Integration: The Cartesian product generation and CSR lookup tables 
  * are handled entirely by AuxGraph, leaving this file to focus strictly on the 
  * retrograde queue logic and DP state definitions.
+ * - Pluggable State Layout (`--layout config|robber|blocked`): Every state is 
+ * reached through AuxGraph's layout accessors, so the table can be stored 
+ * config-major (robber moves local), robber-major (team moves local) or in 
+ * tiles of `--block-configs B` configs x N robbers, and benchmarked per graph.
  * * PERFORMANCE METRICS (on scotlandyard-yellow with 3 cops)
  * - Memory -> 5.72 GB 
  * - Time -> 70 seconds
@@ -30,6 +39,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 // --- BIT-PACKING CONSTANTS ---
 // MSB is 1 for Robber's turn, 0 for Cop's turn. 
@@ -37,6 +47,11 @@
 constexpr size_t ROBBER_TURN_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
 constexpr size_t STATE_ID_MASK = ~ROBBER_TURN_BIT;
 
+// --- LOCALITY CONSTANTS ---
+// Levels are bucketed on the top LEVEL_SORT_BITS bits of the state ID (smaller levels are just sorted)
+constexpr int LEVEL_SORT_BITS = 12;
+constexpr size_t LEVEL_SORT_MIN = 4096;
+
 // --- DP STATE DEFINITION ---
 struct DataItem {
     uint8_t copTurnWins : 1;
@@ -44,9 +59,49 @@ struct DataItem {
     uint8_t robberSafeMoves : 6;
 };
 
+// --- PROCEDURAL HELPERS ---
+
+/**
+ * Reorders one BFS level of the work queue (count packed entries) by state ID, 
+ * in place. Large levels get a single American flag pass over the top 
+ * LEVEL_SORT_BITS bits of the state ID, which already keeps every bucket 
+ * within a small slice of the state table; small ones are fully sorted.
+ */
+void sortLevelByState(size_t* level, size_t count, size_t numStates) {
+
+    if (count < LEVEL_SORT_MIN) {
+        std::sort(level, level + count, [](size_t a, size_t b) { return (a & STATE_ID_MASK) < (b & STATE_ID_MASK); });
+        return;
+    }
+
+    constexpr size_t BUCKETS = (size_t)1 << LEVEL_SORT_BITS;
+    int shift = 0;
+    while (((numStates - 1) >> shift) >= BUCKETS) shift++;
+    auto bucketOf = [&](size_t packed) { return (packed & STATE_ID_MASK) >> shift; };
+
+    std::vector<size_t> next(BUCKETS + 1, 0);
+    for (size_t i = 0; i < count; ++i) next[bucketOf(level[i]) + 1]++;
+    for (size_t b = 0; b < BUCKETS; ++b) next[b + 1] += next[b];
+    std::vector<size_t> end(next.begin() + 1, next.end());
+
+    // Cycle every misplaced entry into its bucket, each swap settles one entry for good
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        while (next[b] < end[b]) {
+            size_t item = level[next[b]];
+            size_t itemBucket = bucketOf(item);
+            while (itemBucket != b) {
+                std::swap(item, level[next[itemBucket]++]);
+                itemBucket = bucketOf(item);
+            }
+            level[next[b]++] = item;
+        }
+    }
+}
+
 // --- MAIN ALGORITHM ---
 
-void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
+template <typename Layout>
+void solveCopsAndRobbers(Graph* g, const char* filename, int k, const Layout& layout, const char* cacheDir, Profiler* p) {
 
     int N = g->nodeCount;
     if (N == 0) {
@@ -64,7 +119,10 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
 
     // STEP 2 --- Build Aux Graph & Queue DP Allocation
     p->enter("Build Aux Graph");
-    AuxGraph<DataItem> aux(k, N, &adj, &mem);
+    std::string cacheFile = TransitionCache::getDefaultPath(cacheDir, filename, k);
+    AuxGraph<DataItem, Layout> aux;
+    aux.layout = layout;
+    aux.constructFrom(k, &adj, &mem, cacheFile.c_str());
     if (aux.configCount == 0) return;
 
     // STEP 3 --- Allocate Custom Queue & Commit Memory
@@ -73,7 +131,7 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
     size_t maxQueueSize = aux.numStates * 2; 
 
     std::cout << "Generating states for " << k << " cops...\n";
-    std::cout << "Total States: " << aux.numStates << "\n";
+    std::cout << "Total States: " << aux.numStates << " (" << aux.layout.getName() << " layout)\n";
 
     mem.requestAlloc("Analysis Work Queue", maxQueueSize, &workQueue);
     mem.allocate(); // Allocates both aux.states and workQueue cleanly
@@ -123,30 +181,38 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
     {
         size_t cId;
         int r;
-        size_t copTransStart, copTransEnd, i;
+        size_t copTransCount, i;
+        std::vector<size_t> copTrans(aux.table.transitions.maxRowLength);
         size_t prevStateId;
         uint8_t* rEdges;
         int eIdx;
 
+        // Entries before levelEnd belong to the level being processed, the ones after it to the next level
+        size_t levelEnd = qReadHead;
+
         while (qReadHead < qWriteHead) {
+
+            if (qReadHead == levelEnd) {
+                levelEnd = qWriteHead;
+                sortLevelByState(&workQueue[qReadHead], levelEnd - qReadHead, aux.numStates);
+            }
             
             // Unpack the node
             size_t packedNode = workQueue[qReadHead++];
             bool isRobberTurn = (packedNode & ROBBER_TURN_BIT) != 0;
             size_t stateId = packedNode & STATE_ID_MASK;
             
-            cId = stateId / N;
-            r = stateId % N;
+            aux.splitStateId(stateId, &cId, &r);
 
             if (isRobberTurn) {
                 // STATE: Cops won, and it was the Robber's turn.
                 // LOGIC: The Cops' previous turn is guaranteed to be a win if they 
                 // simply CHOOSE to transition to this state.
                 
-                aux.getCopTransitions(cId, copTransStart, copTransEnd);
+                copTransCount = aux.decodeCopTransitions(cId, copTrans.data());
                 
-                for (i = copTransStart; i < copTransEnd; ++i) {
-                    prevStateId = aux.transitions[i] + r; 
+                for (i = 0; i < copTransCount; ++i) {
+                    prevStateId = aux.getStateId(copTrans[i], r);
                     
                     if (!aux.states[prevStateId].copTurnWins) {
                         aux.states[prevStateId].copTurnWins = 1;
@@ -160,7 +226,7 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
                 // stepping here allows the cops to force a win.
                 
                 // 1. Robber stayed in place
-                prevStateId = cId * N + r;
+                prevStateId = aux.getStateId(cId, r);
                 if (!aux.states[prevStateId].robberTurnWins) {
                     aux.states[prevStateId].robberSafeMoves--;
                     if (aux.states[prevStateId].robberSafeMoves == 0) {
@@ -173,7 +239,7 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
                 rEdges = adj.getEdges(r);
                 eIdx = 0;
                 while (rEdges[eIdx] != 255) {
-                    prevStateId = cId * N + rEdges[eIdx];
+                    prevStateId = aux.getStateId(cId, rEdges[eIdx]);
                     if (!aux.states[prevStateId].robberTurnWins) {
                         aux.states[prevStateId].robberSafeMoves--;
                         if (aux.states[prevStateId].robberSafeMoves == 0) {
@@ -226,9 +292,33 @@ void solveCopsAndRobbers(Graph* g, int k, Profiler* p) {
 // --- ENTRY POINT ---
 int main(int argc, char* argv[]) {
 
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+    std::string layoutName = "config";
+    size_t blockConfigs = 64;
+    const char* cacheDir = nullptr;
+    bool badArgs = (argc < 3);
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--layout" && i + 1 < argc) {
+            layoutName = argv[++i];
+            badArgs = (layoutName != "config" && layoutName != "robber" && layoutName != "blocked");
+        } else if (arg == "--block-configs" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            blockConfigs = std::stoull(argv[++i]);
+            badArgs = (blockConfigs == 0 || (blockConfigs & (blockConfigs - 1)) != 0);
+        } else if (arg == "--transition-cache") {
+            cacheDir = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) ? argv[++i] : "transition_cache";
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [--layout config|robber|blocked] [--block-configs B] [--transition-cache [d]]\n";
         std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        std::cout << "  --layout          state table order: cId * N + r (default), r * configs + cId, or tiles\n";
+        std::cout << "  --block-configs B configs per tile of the blocked layout, a power of two (default: 64)\n";
+        std::cout << "  --transition-cache [d] keep the transition table in directory d for later runs (default: transition_cache)\n";
         return 1;
     }
 
@@ -240,7 +330,15 @@ int main(int argc, char* argv[]) {
 
     Graph g(filename);
     
-    solveCopsAndRobbers(&g, k, &p);
+    if (layoutName == "robber") {
+        solveCopsAndRobbers(&g, filename, k, RobberMajorLayout(), cacheDir, &p);
+    } else if (layoutName == "blocked") {
+        BlockedLayout layout;
+        layout.blockConfigs = blockConfigs;
+        solveCopsAndRobbers(&g, filename, k, layout, cacheDir, &p);
+    } else {
+        solveCopsAndRobbers(&g, filename, k, ConfigMajorLayout(), cacheDir, &p);
+    }
 
     p.print(); 
 
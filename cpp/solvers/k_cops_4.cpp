@@ -4,36 +4,77 @@
  * ============================================================================
  * * OVERVIEW
  * Solves the Cops and Robbers graph game using (A) exact combinatorial state 
- * generation, (B) parallelized CSR transition building, and (C) a multithreaded 
+ * generation, (B) a parallel-built, disk-cached CSR transition table, and (C) a multithreaded 
  * Level-Synchronous BFS retrograde analysis driven by lock-free atomics.
  * * DEEPER DIVE
  * - Level-Synchronous BFS - Instead of a single continuous queue, the workload is 
  * divided into "frontiers" or "waves". Thread workers process chunks of the 
- * `currentFrontier` simultaneously, pushing discovered winning states into local 
- * vectors. These local vectors are then merged to form the next wave.
+ * current wave simultaneously, setting discovered winning states straight into 
+ * the next wave's bitmap in a `WaveFrontier`. Between waves that bitmap is kept, 
+ * or compacted into a sorted list of 32-bit state IDs when that is smaller, so 
+ * the frontier costs 4 bits per state instead of a `size_t` per state.
+ * - Push/Pull Waves: A wave that touches a large share of the open states is 
+ * pulled instead (after Beamer's direction-optimising BFS): every config with an 
+ * open Cop turn scans its row once for a lost Robber turn, then every open 
+ * Robber turn recounts its safe moves. `preferPull` weighs the two per wave, 
+ * and both produce the exact same next wave.
  * - Lock-Free Concurrency (The Magic Tricks): Multiple threads will inevitably 
  * find different paths that lead back to the *same* prior state. To prevent a 
  * state from being pushed to the next frontier multiple times (which would cause 
- * an exponential explosion in redundant work), we use `std::atomic` arrays.
- * 1. `exchange(1)`: Sets a state to a win and returns what it *used* to be. 
- * If it returns 0, this specific thread was the one to flip it, so this 
- * thread "owns" the right to queue it.
- * 2. `fetch_sub(1)`: Decrements safe moves safely across threads. If it 
- * returns 1, this specific thread delivered the final blow that trapped 
- * the robber, granting it the right to queue the state.
- * - Parallel Prefix Sum: Transition building uses a map-reduce pattern where 
- * threads build local moves, and the main thread uses a prefix sum array to 
- * pre-calculate exact offsets for a unified, lock-free global insertion phase.
+ * an exponential explosion in redundant work), the states live in a 
+ * `PackedStateStore` of atomic 64-bit words.
+ * 1. `markCopTurnWin`: A `fetch_or` on the state's win bit returns what the 
+ * word *used* to be. If the bit was 0, this specific thread was the one to 
+ * flip it, so this thread "owns" the right to queue it.
+ * 2. `decrementSafeMoves`: Counts the robber's safe moves down with a CAS on 
+ * the word. The thread that takes the last one delivered the final blow that 
+ * trapped the robber, granting it the right to queue the state.
+ * - Sub-Byte States: Cop turn wins take one bit per state and the safe move 
+ * counters ceil(log2(maxDegree + 2)) bits, where three byte arrays used to 
+ * take 24. A counter of zero doubles as the Robber turn win flag.
+ * - Counterless Mode (`--counterless`): Drops the counters for a Robber turn 
+ * win bit, 2 bits per state. When a Cop turn state is won, each robber 
+ * predecessor re-checks its closed neighbourhood and is won once no escape 
+ * is left. Costs a neighbourhood scan per predecessor, for problems that do 
+ * not fit in memory otherwise.
+ * - Shared Transition Cache: The table is built by `TransitionCache` in two 
+ * parallel passes (size every row, prefix sum, encode each row in place) 
+ * straight into Allocator memory. With `--transition-cache [dir]` it is also 
+ * written to dir (default transition_cache/), and later runs, of this or any 
+ * other solver, memory map it instead of rebuilding it.
+ * - Persistent Thread Pool: One `ThreadPool` runs the table build, the capture 
+ * init and every wave. Its threads park between jobs instead of being created 
+ * and joined each time, and each job splits its range into chunks that idle 
+ * threads steal from busy ones. `--threads n` sets the pool size (default one 
+ * per core) and `--pin-threads` pins each thread to its own core.
+ * - Asynchronous Mode (`--async`): Win/loss propagation does not need waves, 
+ * so this drops the barrier between them. Each thread keeps a lock-free 
+ * `WorkStealingQueue` of won states, pushes what it resolves onto its own 
+ * queue and steals from the others when it runs dry, until no state is queued 
+ * or in flight anywhere. The same `fetch_or` and countdown ownership tricks 
+ * keep every state queued at most once.
+ * - Vertex Relabelling (`--relabel bfs|rcm`): Node IDs otherwise follow the 
+ * row order of the matrix file. A `VertexOrdering` pass between `Graph` and 
+ * `AdjacencyList` renumbers them in BFS or reverse Cuthill-McKee order, so 
+ * robber moves stay within a few cache lines and a team move's targets land 
+ * in nearby configs. The start positions are printed in the file's labels.
  * * PERFORMANCE METRICS (on scotlandyard-yellow with 3 cops)
- * - Memory -> 3.68 GB 
- * - Time -> 14 seconds
+ * - Memory -> 0.43 GB (peak RSS, 5 bits per state)
+ * - Time -> 211 seconds (1 thread)
  * ============================================================================
  */
 
 #include "Graph.h"
 #include "AdjacencyList.h"
 #include "copconfig.h"
+#include "TransitionCache.h"
 #include "Allocator.h"
+#include "PackedStateStore.h"
+#include "WaveFrontier.h"
+#include "RobberSet.h"
+#include "ThreadPool.h"
+#include "WorkStealingQueue.h"
+#include "VertexOrdering.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -42,204 +83,168 @@
 #include <atomic>
 #include <cstdint>
 #include <iomanip>
-
-// --- BIT-PACKING CONSTANTS ---
-// MSB is 1 for Robber's turn, 0 for Cop's turn. 
-// The rest of the bits hold the stateId.
-constexpr size_t ROBBER_TURN_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
-constexpr size_t STATE_ID_MASK = ~ROBBER_TURN_BIT;
+#include <string>
 
 // --- PROCEDURAL HELPERS ---
 
 /**
- * Builds a Compressed Sparse Row (CSR) representation of all possible team moves
- * across multiple threads. Utilizes a Map-Reduce style pattern to avoid mutex 
- * locks during the transition generation.
+ * Identifies immediate capture states (robber and cop share a node).
+ * Flags them (leaving their safe moves at 0), fills in the safe moves of every 
+ * other state, and pushes the captures to the initial wave (frontier) to 
+ * kickstart the BFS. Configs are split across the pool.
  */
-void buildTransitions(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
-                      std::vector<size_t>& outTransitionHeads, std::vector<size_t>& outTransitions) {
-    
-    // 1. Determine thread count and chunk sizes
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if (numThreads == 0) numThreads = 8; // Fallback
+void initializeCaptures(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
+                        PackedStateStore& states, WaveFrontier& frontier, ThreadPool& pool) {
     
-    size_t chunkSize = (configCount + numThreads - 1) / numThreads;
-
-    std::cout << "Building transition table using " << numThreads << " threads...\n";
-
-    // 2. Thread-local storage and shared tracking
-    std::vector<std::thread> threads;
-    std::vector<std::vector<size_t>> allLocalTransitions(numThreads);
-    std::vector<size_t> transitionCounts(configCount, 0); // Safe: threads write to distinct indices
-
-    // 3. The Worker Lambda
-    auto worker = [&](unsigned int tId, size_t startId, size_t endId) {
-        // GENEROUS PRE-ALLOCATION: Guess an average of 12 moves per configuration
-        allLocalTransitions[tId].reserve((endId - startId) * 12);
+    uint8_t robberDegrees[256];
+    for (int r = 0; r < N; ++r) {
+        int eCount = 1; 
+        uint8_t* edges = adj.getEdges(r);
+        while (edges[eCount - 1] != 255) eCount++;
+        robberDegrees[r] = static_cast<uint8_t>(eCount);
+    }
 
-        std::vector<size_t> tempMoves;
-        tempMoves.reserve(1024); 
+    const size_t INIT_BATCH = 4096;
+    std::atomic<size_t> initialWins{0};
 
-        uint8_t options[MAX_COPS][256];
-        int optionCount[MAX_COPS];
-        int odometer[MAX_COPS];
-        uint8_t moveConfig[MAX_COPS];
+    pool.parallelFor(configCount, INIT_BATCH, [&](unsigned int, size_t startId, size_t endId) {
+        size_t localWins = 0;
 
-        for (size_t cId = startId; cId < endId; cId++) {
-            tempMoves.clear(); 
+        for (size_t cId = startId; cId < endId; ++cId) {
             const uint8_t* currentCops = &configs[cId * k];
             
-            for (int i = 0; i < k; i++) {
-                uint8_t u = currentCops[i];
-                options[i][0] = u; 
-                int count = 1;
+            for (int r = 0; r < N; ++r) {
+                size_t stateId = cId * N + r;
                 
-                uint8_t* edges = adj.getEdges(u);
-                int eIdx = 0;
-                while (edges[eIdx] != 255) {
-                    options[i][count++] = edges[eIdx++];
-                }
-                optionCount[i] = count;
-            }
-
-            memset(odometer, 0, MAX_COPS * sizeof(int));
-            
-            while (true) {
+                bool caught = false;
                 for (int i = 0; i < k; ++i) {
-                    moveConfig[i] = options[i][odometer[i]];
-                }
-                
-                std::sort(moveConfig, moveConfig + k);
-                size_t nextId = static_cast<size_t>(-1); 
-                size_t left = 0;
-                size_t right = configCount - 1;
-                while (left <= right) {
-                    size_t mid = left + (right - left) / 2;
-                    int cmp = std::memcmp(&configs[mid * k], moveConfig, k);
-                    if (cmp == 0) {
-                        nextId = mid;
+                    if (currentCops[i] == r) {
+                        caught = true;
                         break;
                     }
-                    if (cmp < 0) left = mid + 1;
-                    else right = mid - 1;
                 }
                 
-                tempMoves.push_back(nextId * N);
-                
-                int p = k - 1;
-                while (p >= 0) {
-                    odometer[p]++;
-                    if (odometer[p] < optionCount[p]) break;
-                    odometer[p] = 0;
-                    p--;
+                if (caught) {
+                    states.markCapture(stateId);
+                    
+                    // Push both turn phases into the initial frontier
+                    frontier.push(stateId, false);   // Cop's turn
+                    frontier.push(stateId, true);    // Robber's turn
+                    localWins++;
+                } else {
+                    // Counters of neighbouring batches can share a word, so this has to be the atomic overwrite
+                    states.resetSafeMoves(stateId, robberDegrees[r]);
                 }
-                if (p < 0) break;
             }
-
-            std::sort(tempMoves.begin(), tempMoves.end());
-            tempMoves.erase(std::unique(tempMoves.begin(), tempMoves.end()), tempMoves.end());
-            
-            // Log the size and append to local thread storage
-            transitionCounts[cId] = tempMoves.size();
-            allLocalTransitions[tId].insert(allLocalTransitions[tId].end(), tempMoves.begin(), tempMoves.end());
         }
-    };
 
-    // 4. Spawn Threads
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        size_t startId = i * chunkSize;
-        size_t endId = std::min(startId + chunkSize, configCount);
-        if (startId >= configCount) break; // Prevent over-spawning on tiny graphs
-        threads.emplace_back(worker, i, startId, endId);
-    }
+        initialWins.fetch_add(localWins, std::memory_order_relaxed);
+    });
 
-    // 5. Wait for all threads to finish their chunks
-    for (auto& t : threads) {
-        t.join();
-    }
+    std::cout << "Initialized " << initialWins << " winning states (Captures).\n";
+    std::cout << "Starting Multi-Threaded Level-Synchronous BFS...\n";
+}
 
-    // --- 6. THE MERGE PHASE ---
-    outTransitionHeads.assign(configCount + 1, 0);
-    size_t totalTransitions = 0;
+/**
+ * Picks the direction of the next wave, after Beamer's direction-optimising BFS.
+ * Push pays for the team moves out of every Robber turn on the frontier and a 
+ * neighbourhood per Cop turn. Pull pays for the team moves out of every config 
+ * with an open Cop turn, checked against each of its open robber positions 
+ * until one is lost, a neighbourhood per open Robber turn, and a scan of every 
+ * state to find the open ones. Pull only reads where push does an atomic 
+ * read-modify-write, hence PULL_ADVANTAGE.
+ */
+bool preferPull(const WaveFrontier& frontier, size_t openCopStates, size_t openRobberStates, size_t configCount,
+                size_t numStates, double movesPerConfig, double closedDegree) {
 
-    // Prefix sum to build the exact transition heads
-    for (size_t i = 0; i < configCount; ++i) {
-        outTransitionHeads[i] = totalTransitions;
-        totalTransitions += transitionCounts[i];
-    }
-    outTransitionHeads[configCount] = totalTransitions;
+    constexpr double PULL_ADVANTAGE = 2.0;
+    constexpr double CHECK_COST = 0.25; // One robber position checked against one team move, relative to decoding the move
 
-    // Exact allocation for the global array (0 wasted space)
-    outTransitions.clear();
-    outTransitions.reserve(totalTransitions); 
-    
-    // Stitch the local chunks together safely in a single thread
-    for (unsigned int i = 0; i < numThreads; ++i) {
-        if (!allLocalTransitions[i].empty()) {
-            outTransitions.insert(outTransitions.end(), 
-                                  allLocalTransitions[i].begin(), 
-                                  allLocalTransitions[i].end());
-        }
-    }
+    double copFrontier = static_cast<double>(frontier.waveSize - frontier.robberTurnSize);
+    double robberFrontier = static_cast<double>(frontier.robberTurnSize);
+    double pullRows = static_cast<double>(std::min(configCount, openCopStates));
+
+    double pushWork = robberFrontier * movesPerConfig + copFrontier * closedDegree;
+    double pullWork = pullRows * movesPerConfig + openCopStates * movesPerConfig * CHECK_COST + openRobberStates * closedDegree +
+                      static_cast<double>(numStates);
 
-    std::cout << "Transitions generated. Total edge pointers: " << outTransitions.size() << "\n";
+    return pushWork * PULL_ADVANTAGE > pullWork;
 }
 
 /**
- * Identifies immediate capture states (robber and cop share a node).
- * Flags them, sets safe moves to 0, and pushes them to the initial wave (frontier)
- * to kickstart the BFS.
+ * Runs the whole retrograde analysis without waves (`--async`), starting from 
+ * the current wave of the frontier (the captures). Every thread works off its 
+ * own lock-free queue, depth first, and steals the oldest item of another 
+ * queue when its own is empty. `pending` counts the states queued or being 
+ * expanded; an expansion adds its children before dropping itself, so it only 
+ * reaches zero once the whole game is solved. Items are stateId << 1 | robberTurn.
+ * Returns the number of states resolved, captures included.
  */
-void initializeCaptures(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
-                        std::atomic<uint8_t>* copTurnWins, std::atomic<uint8_t>* robberTurnWins, std::atomic<uint8_t>* robberSafeMoves,
-                        std::vector<size_t>& currentFrontier) {
-    
-    uint8_t robberDegrees[256];
-    for (int r = 0; r < N; ++r) {
-        int eCount = 1; 
-        uint8_t* edges = adj.getEdges(r);
-        while (edges[eCount - 1] != 255) eCount++;
-        robberDegrees[r] = static_cast<uint8_t>(eCount);
-    }
+template <typename Expand>
+size_t runAsyncRetrograde(WaveFrontier& frontier, ThreadPool& pool, Expand&& expandState) {
 
-    int initialWins = 0;
-    
-    for (size_t cId = 0; cId < configCount; ++cId) {
-        const uint8_t* currentCops = &configs[cId * k];
-        
-        for (int r = 0; r < N; ++r) {
-            size_t stateId = cId * N + r;
-            
-            bool caught = false;
-            for (int i = 0; i < k; ++i) {
-                if (currentCops[i] == r) {
-                    caught = true;
-                    break;
-                }
+    const size_t QUEUE_CAPACITY = 4096;
+
+    std::vector<WorkStealingQueue> queues(pool.numThreads);
+    for (WorkStealingQueue& queue : queues) queue.constructFrom(QUEUE_CAPACITY);
+
+    std::atomic<int64_t> pending{static_cast<int64_t>(frontier.waveSize)};
+    std::atomic<size_t> resolved{0};
+
+    // Deal the captures out across the queues
+    pool.parallelFor(frontier.getBatchCount(), 1, [&](unsigned int tId, size_t startBatch, size_t endBatch) {
+        for (size_t batch = startBatch; batch < endBatch; ++batch) {
+            frontier.forEachInBatch(batch, [&](size_t stateId, bool isRobberTurn) {
+                queues[tId].push((static_cast<uint64_t>(stateId) << 1) | static_cast<uint64_t>(isRobberTurn));
+            });
+        }
+    });
+
+    pool.run([&](unsigned int tId) {
+        WorkStealingQueue& own = queues[tId];
+        unsigned int numThreads = pool.numThreads;
+        size_t localResolved = 0;
+        int idleSpins = 0;
+
+        while (true) {
+            uint64_t item;
+            bool found = own.pop(&item);
+            for (unsigned int i = 1; !found && i < numThreads; ++i) {
+                found = queues[(tId + i) % numThreads].steal(&item);
             }
-            
-            if (caught) {
-                copTurnWins[stateId].store(1, std::memory_order_relaxed);
-                robberTurnWins[stateId].store(1, std::memory_order_relaxed);
-                robberSafeMoves[stateId].store(0, std::memory_order_relaxed); 
-                
-                // Push both turn phases into the initial frontier
-                currentFrontier.push_back(stateId);                     // Cop's turn
-                currentFrontier.push_back(stateId | ROBBER_TURN_BIT);   // Robber's turn
-                initialWins++;
-            } else {
-                robberSafeMoves[stateId].store(robberDegrees[r], std::memory_order_relaxed);
+
+            if (!found) {
+                if (pending.load(std::memory_order_acquire) == 0) break;
+                if (++idleSpins > 64) std::this_thread::yield();
+                continue;
             }
+            idleSpins = 0;
+
+            int64_t produced = 0;
+            expandState(static_cast<size_t>(item >> 1), (item & 1) != 0, [&](size_t prevId, bool prevRobberTurn) {
+                own.push((static_cast<uint64_t>(prevId) << 1) | static_cast<uint64_t>(prevRobberTurn));
+                produced++;
+            });
+
+            // Children are already queued, so this never lets pending touch zero early
+            if (produced != 1) pending.fetch_add(produced - 1, std::memory_order_acq_rel);
+            localResolved++;
         }
-    }
 
-    std::cout << "Initialized " << initialWins << " winning states (Captures).\n";
-    std::cout << "Starting Multi-Threaded Level-Synchronous BFS...\n";
+        resolved.fetch_add(localResolved, std::memory_order_relaxed);
+    });
+
+    size_t queueBytes = 0;
+    for (const WorkStealingQueue& queue : queues) queueBytes += queue.getMemoryFootprint();
+    std::cout << "[Memory] async work queues (peak): " << std::fixed << std::setprecision(2)
+              << static_cast<double>(queueBytes) / (1024.0 * 1024.0) << " MB\n";
+
+    return resolved.load(std::memory_order_relaxed);
 }
 
 // --- MAIN ALGORITHM ---
 
-void solveCopsAndRobbers(Graph* g, int k) {
+void solveCopsAndRobbers(Graph* g, const VertexOrdering& ordering, const char* filename, const char* cacheDir, int k, bool counterless, bool async, unsigned int numThreads, bool pinThreads) {
 
     int N = g->nodeCount;
     if (N == 0) {
@@ -251,149 +256,225 @@ void solveCopsAndRobbers(Graph* g, int k) {
     AdjacencyList adj(g);
 
     // STEP 2 --- Cop Configurations
-    size_t configCount;
-    uint8_t* configs = generateCopConfigs(k, N, &configCount);
-    if (!configs || configCount == 0) return;
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
 
-    double configsMB = static_cast<double>(configCount * k * sizeof(uint8_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] configs array: " << std::fixed << std::setprecision(2) << configsMB << " MB\n";
+    CopConfigRanker ranker(k, N);
+    size_t configCount = ranker.configCount;
+    if (configCount == 0) return;
 
-    // STEP 3 --- CSR Transitions
-    std::vector<size_t> transitionHeads;
-    std::vector<size_t> transitions;
-    buildTransitions(configCount, k, N, configs, adj, transitionHeads, transitions);
+    // Every parallel phase from here on runs on these threads
+    ThreadPool pool;
+    pool.constructFrom(numThreads, pinThreads);
+    std::cout << "Thread pool: " << pool.numThreads << " threads" << (pinThreads ? " (pinned)" : "") << "\n";
 
-    double transitionsMB = static_cast<double>((transitionHeads.capacity() + transitions.capacity()) * sizeof(size_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] transitions CSR: " << std::fixed << std::setprecision(2) << transitionsMB << " MB\n";
+    // STEP 3 --- CSR Transitions (mapped from disk when an earlier run left them behind)
+    Allocator mem;
+    TransitionCache table;
+    std::string cacheFile = TransitionCache::getDefaultPath(cacheDir, std::string(filename) + ordering.getCacheSuffix(), k);
+    if (!table.constructFrom(&adj, &ranker, cacheFile.c_str(), &mem, &pool)) return;
+    if (table.loadedFromDisk) mem.trackExternal("Transition Cache (Mapped)", table.getMappedBytes());
+    const uint8_t* configs = table.configs;
+
+    double tableMB = static_cast<double>(table.getMemoryFootprint() + ranker.getMemoryFootprint()) / (1024.0 * 1024.0);
+    double mappedMB = static_cast<double>(table.getMappedBytes()) / (1024.0 * 1024.0);
+    std::cout << "[Memory] configs + transitions CSR + ranker (heap): " << std::fixed << std::setprecision(2) << tableMB << " MB ("
+              << mappedMB << " MB mapped)\n";
 
     // STEP 4 --- Allocate Game States via Arena Allocator
-    Allocator mem;
-    std::atomic<uint8_t>* copTurnWins = nullptr;
-    std::atomic<uint8_t>* robberTurnWins = nullptr;
-    std::atomic<uint8_t>* robberSafeMoves = nullptr;
-    
     size_t numStates = configCount * N;
     std::cout << "Generating ATOMIC states for " << k << " cops...\n";
     std::cout << "Total States: " << numStates << "\n";
 
-    mem.requestAlloc("Cop Turn Wins", numStates, &copTurnWins);
-    mem.requestAlloc("Robber Turn Wins", numStates, &robberTurnWins);
-    mem.requestAlloc("Robber Safe Moves", numStates, &robberSafeMoves);
-
-    mem.allocate();
-
-    // Initialize atomics safely (memset on atomics is compiler-dependent)
-    for (size_t i = 0; i < numStates; ++i) {
-        copTurnWins[i].store(0, std::memory_order_relaxed);
-        robberTurnWins[i].store(0, std::memory_order_relaxed);
-        robberSafeMoves[i].store(0, std::memory_order_relaxed);
-    }
+    // The robber has at most maxDegree + 1 safe moves (staying put counts)
+    PackedStateStore states;
+    states.constructFrom(numStates, adj.maxDegree + 1, &mem, counterless);
+    std::cout << "[Memory] game states: " << std::fixed << std::setprecision(2) << states.getBitsPerState() << " bits per state\n";
 
-    std::vector<size_t> currentFrontier;
-    // Pre-allocate to prevent reallocations on Pass 1
-    currentFrontier.reserve(configCount * N); 
+    // Both waves in flight share two state space bitmaps, the sparse ones packed down to 32-bit lists
+    WaveFrontier frontier;
+    frontier.constructFrom(numStates, &mem);
 
-    double frontierMB = static_cast<double>(currentFrontier.capacity() * sizeof(size_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] BFS Frontier Queue: " << std::fixed << std::setprecision(2) << frontierMB << " MB\n";
+    double frontierMB = static_cast<double>(frontier.getMemoryFootprint()) / (1024.0 * 1024.0);
+    std::cout << "[Memory] BFS Frontier (bitmap or 32-bit list per wave): " << std::fixed << std::setprecision(2) << frontierMB << " MB\n";
 
     mem.print();
 
     // STEP 5 --- INITIALIZATION
-    initializeCaptures(configCount, k, N, configs, adj, copTurnWins, robberTurnWins, robberSafeMoves, currentFrontier);
+    initializeCaptures(configCount, k, N, configs, adj, states, frontier, pool);
+    frontier.advance(pool);
+
+    // Resolves the predecessors of one newly won state, handing each one this call wins to emit(stateId, robberTurn)
+    auto expandState = [&](size_t stateId, bool isRobberTurn, auto&& emit) {
+        size_t cId = stateId / N;
+        int r = stateId % N;
+
+        if (isRobberTurn) {
+            table.transitions.forEachInRow(cId, [&](size_t prevCId) {
+                size_t prevStateId = prevCId * N + r; 
+            
+                // MAGIC TRICK 1: fetch_or returns the OLD word.
+                // If the bit was 0, WE are the exact thread that changed it to 1.
+                if (states.markCopTurnWin(prevStateId)) {
+                    emit(prevStateId, false); // Cop Turn
+                }
+            });
+        } 
+        else {
+            // Lambda to handle the Robber's backward moves
+            size_t stateBase = cId * N;
+
+            auto processRobberMove = [&](int prevR) {
+                size_t prevId = stateBase + prevR;
+                bool trapped;
+                if (states.counterless) {
+                    // No counter to count down: re-check the robber's whole escape set, and let
+                    // fetch_or pick the one thread that queues it
+                    trapped = !states.isRobberTurnWin(prevId) && states.isRobberTrapped(stateBase, prevR, adj) &&
+                              states.markRobberTurnWin(prevId);
+                } else {
+                    // MAGIC TRICK 2: the CAS countdown reports whether it took the last safe move.
+                    // If it did, WE delivered the killing blow to the Robber.
+                    trapped = states.decrementSafeMoves(prevId);
+                }
+                if (trapped) {
+                    emit(prevId, true); // Robber Turn
+                }
+            };
+
+            // 1. Robber stayed in place
+            processRobberMove(r);
+
+            // 2. Robber moved from adjacent
+            uint8_t* rEdges = adj.getEdges(r);
+            for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
+                processRobberMove(rEdges[eIdx]);
+            }
+        }
+    };
 
     // STEP 6 --- MAIN MULTI-THREADED RETROGRADE LOOP
-    {
+    if (async) {
+        size_t resolved = runAsyncRetrograde(frontier, pool, expandState);
+        std::cout << "Asynchronous retrograde done. States resolved: " << resolved << "\n";
+    } else {
         int passes = 0;
-        unsigned int numThreads = std::thread::hardware_concurrency();
-        if (numThreads == 0) numThreads = 8;
 
-        while (!currentFrontier.empty()) {
-            passes++;
-            size_t frontierSize = currentFrontier.size();
-            size_t chunkSize = (frontierSize + numThreads - 1) / numThreads;
+        // Inputs of the push/pull choice: the average row length and closed degree
+        double movesPerConfig = static_cast<double>(table.transitions.edgeCount) / configCount;
+        double closedDegree = 0.0;
+        for (int r = 0; r < N; ++r) {
+            uint8_t* edges = adj.getEdges(r);
+            for (int eIdx = 0; edges[eIdx] != 255; ++eIdx) closedDegree += 1.0;
+        }
+        closedDegree = closedDegree / N + 1.0;
+
+        size_t openCopStates = numStates - (frontier.waveSize - frontier.robberTurnSize);
+        size_t openRobberStates = numStates - frontier.robberTurnSize;
 
-            std::vector<std::vector<size_t>> localNextFrontiers(numThreads);
-            std::vector<std::thread> threads;
+        while (frontier.waveSize != 0) {
+            passes++;
+            size_t batchCount = frontier.getBatchCount();
+            bool pull = preferPull(frontier, openCopStates, openRobberStates, configCount, numStates,
+                                   movesPerConfig, closedDegree);
+
+            auto worker = [&](size_t startBatch, size_t endBatch) {
+                for (size_t batch = startBatch; batch < endBatch; ++batch) {
+                    frontier.forEachInBatch(batch, [&](size_t stateId, bool isRobberTurn) {
+                        expandState(stateId, isRobberTurn, [&](size_t prevId, bool prevRobberTurn) {
+                            frontier.push(prevId, prevRobberTurn);
+                        });
+                    });
+                }
+            };
 
-            auto worker = [&](unsigned int tId, size_t startIdx, size_t endIdx) {
-                localNextFrontiers[tId].reserve(chunkSize * 2);
+            // Pull, phase A: every config with an open Cop turn decodes its row once, and each open robber
+            // position is won by the first team move into a Robber turn the cops have already won
+            auto copPuller = [&](size_t startId, size_t endId) {
+                for (size_t cId = startId; cId < endId; ++cId) {
+                    size_t stateBase = cId * N;
 
-                for (size_t q = startIdx; q < endIdx; ++q) {
-                    size_t packedNode = currentFrontier[q];
-                    bool isRobberTurn = (packedNode & ROBBER_TURN_BIT) != 0;
-                    size_t stateId = packedNode & STATE_ID_MASK;
-                    
-                    size_t cId = stateId / N;
-                    int r = stateId % N;
-
-                    if (isRobberTurn) {
-                        size_t copTransStart = transitionHeads[cId];
-                        size_t copTransEnd = transitionHeads[cId + 1];
-                        
-                        for (size_t i = copTransStart; i < copTransEnd; ++i) {
-                            size_t prevStateId = transitions[i] + r; 
-                            
-                            // MAGIC TRICK 1: exchange(1) returns the OLD value.
-                            // If it returns 0, WE are the exact thread that changed it to 1.
-                            if (copTurnWins[prevStateId].exchange(1, std::memory_order_relaxed) == 0) {
-                                localNextFrontiers[tId].push_back(prevStateId); // Cop Turn (MSB 0)
+                    RobberSet open;
+                    open.clear();
+                    for (int r = 0; r < N; ++r) {
+                        if (!states.isCopTurnWin(stateBase + r)) open.set(r);
+                    }
+                    if (open.count() == 0) continue;
+
+                    table.transitions.forEachInRow(cId, [&](size_t nextCId) {
+                        size_t nextBase = nextCId * N;
+                        for (int w = 0; w < ROBBER_SET_WORDS; ++w) {
+                            uint64_t bits = open.words[w];
+                            while (bits != 0) {
+                                int r = w * 64 + __builtin_ctzll(bits);
+                                bits &= bits - 1;
+                                if (states.isRobberTurnWin(nextBase + r)) {
+                                    open.words[w] &= ~((uint64_t)1 << (r & 63));
+                                    if (states.markCopTurnWin(stateBase + r)) {
+                                        frontier.push(stateBase + r, false);
+                                    }
+                                }
                             }
                         }
-                    } 
-                    else {
-                        // Lambda to handle the Robber's backward moves
-                        auto processRobberMove = [&](size_t prevId) {
-                            // MAGIC TRICK 2: fetch_sub(1) returns the OLD value.
-                            // If it returns 1, WE delivered the killing blow to the Robber.
-                            if (robberSafeMoves[prevId].fetch_sub(1, std::memory_order_relaxed) == 1) {
-                                robberTurnWins[prevId].store(1, std::memory_order_relaxed);
-                                localNextFrontiers[tId].push_back(prevId | ROBBER_TURN_BIT); // Robber Turn (MSB 1)
-                            }
-                        };
+                    });
+                }
+            };
 
-                        // 1. Robber stayed in place
-                        processRobberMove(cId * N + r);
+            // Pull, phase B: every open Robber turn recounts its safe moves against the Cop turn wins
+            // Wins from phase A still count as safe here, since the push wave that visits them counts them down
+            // (a later pull wave simply recounts)
+            auto robberPuller = [&](size_t startId, size_t endId) {
+                for (size_t cId = startId; cId < endId; ++cId) {
+                    size_t stateBase = cId * N;
+
+                    for (int r = 0; r < N; ++r) {
+                        size_t stateId = stateBase + r;
+                        if (states.isRobberTurnWin(stateId)) continue;
+
+                        int safeMoves = 0;
+                        auto countMove = [&](int nextR) {
+                            size_t nextId = stateBase + nextR;
+                            if (!states.isCopTurnWin(nextId) || frontier.isPushed(nextId, false)) safeMoves++;
+                        };
 
-                        // 2. Robber moved from adjacent
+                        countMove(r);
                         uint8_t* rEdges = adj.getEdges(r);
                         for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
-                            processRobberMove(cId * N + rEdges[eIdx]);
+                            countMove(rEdges[eIdx]);
+                        }
+
+                        if (safeMoves == 0) {
+                            if (states.counterless) states.markRobberTurnWin(stateId);
+                            states.resetSafeMoves(stateId, 0);
+                            frontier.push(stateId, true);
+                        } else {
+                            states.resetSafeMoves(stateId, safeMoves);
                         }
                     }
                 }
             };
 
-            // Spawn threads for this wave
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                size_t startIdx = i * chunkSize;
-                size_t endIdx = std::min(startIdx + chunkSize, frontierSize);
-                if (startIdx >= frontierSize) break;
-                threads.emplace_back(worker, i, startIdx, endIdx);
-            }
-
-            // Wait for wave to complete
-            for (auto& t : threads) {
-                t.join();
-            }
+            // Rows vary a lot in cost, so configs go out in small chunks for the pool to balance
+            const size_t PULL_BATCH = 64;
 
-            // --- MERGE PHASE ---
-            size_t newFrontierSize = 0;
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                newFrontierSize += localNextFrontiers[i].size();
+            if (pull) {
+                // Phase B reads the Cop turn wins, so phase A has to be finished first
+                pool.parallelFor(configCount, PULL_BATCH, [&](unsigned int, size_t startId, size_t endId) { copPuller(startId, endId); });
+                pool.parallelFor(configCount, PULL_BATCH, [&](unsigned int, size_t startId, size_t endId) { robberPuller(startId, endId); });
+                frontier.discard();
+            } else {
+                pool.parallelFor(batchCount, 1, [&](unsigned int, size_t startBatch, size_t endBatch) { worker(startBatch, endBatch); });
             }
 
-            currentFrontier.clear();
-            currentFrontier.reserve(newFrontierSize); // Guarantee no reallocations during insert
-            
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                if (!localNextFrontiers[i].empty()) {
-                    currentFrontier.insert(currentFrontier.end(), 
-                                           localNextFrontiers[i].begin(), 
-                                           localNextFrontiers[i].end());
-                }
-            }
+            // --- NEXT WAVE ---
+            // The workers pushed straight into the frontier bitmap, so there is nothing to merge, only a form to pick
+            size_t newFrontierSize = frontier.advance(pool);
+            openCopStates -= frontier.waveSize - frontier.robberTurnSize;
+            openRobberStates -= frontier.robberTurnSize;
 
-            std::cout << "Wave " << passes << " merged. New states to process: " << newFrontierSize << "\n";
+            std::cout << "Wave " << passes << " (" << (pull ? "pull" : "push") << ") done. New states to process: " << newFrontierSize << "\n";
         }
     }
 
@@ -405,7 +486,7 @@ void solveCopsAndRobbers(Graph* g, int k) {
         bool universalWin = true;
         for (int rStart = 0; rStart < N; ++rStart) {
             size_t stateId = cId * N + rStart;
-            if (!copTurnWins[stateId]) {
+            if (!states.isCopTurnWin(stateId)) {
                 universalWin = false;
                 break;
             }
@@ -418,9 +499,12 @@ void solveCopsAndRobbers(Graph* g, int k) {
 
     if (winningStartConfigId != -1) {
         std::cout << "RESULT: WIN. " << k << " Cop(s) CAN win this graph.\n";
+        uint8_t originalCops[MAX_COPS];
+        ordering.configToOriginal(&configs[winningStartConfigId * k], k, originalCops);
+
         std::cout << "Optimal Cop Start Positions: (";
         for (int i = 0; i < k; ++i) {
-            std::cout << (int)configs[winningStartConfigId * k + i] << (i == k - 1 ? "" : ", ");
+            std::cout << (int)originalCops[i] << (i == k - 1 ? "" : ", ");
         }
         std::cout << ")\n";
     } else {
@@ -429,16 +513,55 @@ void solveCopsAndRobbers(Graph* g, int k) {
     }
 
     // --- CLEANUP ---
-    delete[] configs;
-    // Allocator automatically handles atomics!
+    // TransitionCache releases the configs and table, Allocator automatically handles the state planes!
 }
 
 // --- ENTRY POINT ---
 int main(int argc, char* argv[]) {
 
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+    bool counterless = false;
+    bool async = false;
+    unsigned int numThreads = 0;
+    bool pinThreads = false;
+    VertexOrdering::Method relabel = VertexOrdering::Method::ORIGINAL;
+    const char* cacheDir = nullptr;
+    bool badArgs = (argc < 3);
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--counterless") {
+            counterless = true;
+        } else if (arg == "--async") {
+            async = true;
+        } else if (arg == "--pin-threads") {
+            pinThreads = true;
+        } else if (arg == "--relabel" && i + 1 < argc && VertexOrdering::parseMethod(argv[i + 1], &relabel)) {
+            i++;
+        } else if (arg == "--threads" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            numThreads = static_cast<unsigned int>(std::stoul(argv[++i]));
+        } else if (arg == "--transition-cache") {
+            cacheDir = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) ? argv[++i] : "transition_cache";
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [--counterless] [--async] [--threads n] [--pin-threads] [--relabel m] [--transition-cache [d]]\n";
         std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        std::cout << "  --counterless   2 bits per state: re-check robber escapes instead of counting them\n";
+        std::cout << "  --async         no waves: threads share the work through lock-free queues until none is left\n";
+        std::cout << "  --threads n     worker threads (default: one per core)\n";
+        std::cout << "  --pin-threads   pin each worker thread to its own core\n";
+        std::cout << "  --relabel m     solve under a cache-friendlier node order: bfs or rcm (default: original)\n";
+        std::cout << "  --transition-cache [d] keep the transition table in directory d for later runs (default: transition_cache)\n";
+        return 1;
+    }
+
+    // The escape re-check of counterless mode relies on every earlier wave being finished
+    if (async && counterless) {
+        std::cerr << "Error: --async needs the safe move counters, so it cannot be combined with --counterless.\n";
         return 1;
     }
 
@@ -446,8 +569,17 @@ int main(int argc, char* argv[]) {
     int k = std::stoi(argv[2]);
 
     Graph g(filename);
+
+    // Solve on the relabelled graph, every node printed is mapped back to the file's labels
+    VertexOrdering ordering;
+    ordering.constructFrom(&g, relabel);
+    ordering.apply(&g);
+    if (relabel != VertexOrdering::Method::ORIGINAL) {
+        std::cout << "Vertex order: " << ordering.getMethodName() << " (bandwidth " << ordering.bandwidthBefore
+                  << " -> " << ordering.bandwidthAfter << ")\n";
+    }
     
-    solveCopsAndRobbers(&g, k);
+    solveCopsAndRobbers(&g, ordering, filename, cacheDir, k, counterless, async, numThreads, pinThreads);
 
     return 0;
 }
\ No newline at end of file
@@ -4,64 +4,172 @@
  * ============================================================================
  * * OVERVIEW
  * Solves the Cops and Robbers graph game with a priority on minimizing memory 
- * footprint. It does this using (A) extreme bit-packing of game states, (B) 
+ * footprint. It does this using (A) sub-byte packing of game states, (B) 
  * on-the-fly transition calculations instead of precomputed tables, and (C) a 
  * dynamic, multi-threaded work dispenser for load balancing.
  * * DEEPER DIVE
- * - Extreme Bit-Packing: Instead of separate arrays for Cop turns, Robber turns, 
- * and safe move counts, everything is packed into a single `std::atomic<uint8_t>` 
- * per state. Bit 0 tracks if the cops win, while Bits 1-7 hold the Robber's 
- * safe move counter (max 127).
+ * - Sub-Byte Packing: A `PackedStateStore` keeps one Cop turn win bit per state 
+ * in 64-bit words (set with `fetch_or`), and the Robber's safe move counter in 
+ * a second plane only ceil(log2(maxDegree + 2)) bits wide (counted down with a 
+ * CAS on the word). A Robber turn win is just a counter of zero. On 
+ * scotlandyard-yellow that is 5 bits per state instead of 8.
+ * - Counterless Mode (`--counterless`): Drops the counters for a Robber turn 
+ * win bit, 2 bits per state. Each robber predecessor of a newly won Cop turn 
+ * state re-checks its closed neighbourhood instead, and is won once no escape 
+ * is left. Waves are level-synchronous, so the check made for the last 
+ * neighbour to fall always sees all the others.
  * - On-The-Fly Calculation: The massive CSR transition table from previous versions 
  * is completely removed. Transitions are now generated in real-time during the 
- * BFS loop using a fast-path binary search and unrolled register comparisons. 
+ * BFS loop, and each generated team move is mapped to its config ID with the 
+ * combinatorial number system (`CopConfigRanker`) in exactly k table lookups. 
+ * The `configs` array itself is dropped; configs are unranked when needed. 
  * This trades CPU cycles for massive memory savings.
- * - Dynamic Work Dispenser: Instead of statically chunking the frontier, threads 
- * dynamically pull batches of work using an atomic counter (`sharedIndex.fetch_add`). 
- * This prevents thread starvation if some chunks have denser on-the-fly 
- * calculations than others.
+ * - Memory Budget: An optional budget (in MB) hands the spare RAM to a 
+ * `TransitionProvider`, which precomputes the rows with the largest Cartesian 
+ * products into a compressed CSR cache and generates the rest on the fly. 
+ * A budget of 0 is the pure on-the-fly solver, and a budget big enough for every 
+ * row matches the precomputed k_cops_4, so the trade-off degrades gradually.
+ * - Compile-Time Team Size: The wave loop is dispatched once on k to a kernel 
+ * compiled for that exact team size (`CopKernel<K>`, K = 1..8, with a generic 
+ * fallback above that). A generated row walks only the distinct sorted 
+ * predecessor configs, adding one slot's rank weight per step, so every 
+ * predecessor costs O(1) and gets exactly one `fetch_or`.
+ * - Adaptive Frontier: Workers set the next wave's bits straight into a 
+ * `WaveFrontier` bitmap, so there are no per-thread vectors to merge. Between 
+ * waves it keeps the bitmap (2 bits per state) or compacts it into a sorted 
+ * list of 32-bit state IDs, whichever is smaller, for a flat 4 bits per state.
+ * Either form is walked in state ID order, so each wave is already bucketed
+ * by config and needs no sort.
+ * - Push/Pull Waves: Each wave is run in whichever direction `preferPull` 
+ * estimates to be cheaper (after Beamer's direction-optimising BFS). Push expands 
+ * the predecessors of the frontier. Pull has every config with an open Cop turn 
+ * generate its row once and look for a lost Robber turn, then every open Robber 
+ * turn recounts its safe moves. Both give the exact same next wave, so the two 
+ * mix freely; pull takes the middle waves, where push would generate the same 
+ * row once per robber position.
+ * - Work-Stealing Thread Pool: The transition cache build, capture init and 
+ * every wave run on one persistent `ThreadPool`, whose threads park between 
+ * jobs instead of being created and joined per wave. Each job deals every 
+ * thread a run of batches, and a thread that runs dry steals the back half of 
+ * another's run, so chunks with denser on-the-fly calculations do not starve 
+ * the rest. `--threads n` sets the pool size (default one per core) and 
+ * `--pin-threads` pins each thread to a core.
+ * - Mapped State Tables: The `Allocator` maps its arenas anonymously, so the
+ * state planes and frontier buffers start as the kernel's zero pages with no
+ * serial zeroing pass, and are backed by memory only where the waves first
+ * write, on whichever thread does it. Arenas ask for transparent huge pages
+ * (`--huge-pages thp`, or `reserved` for the MAP_HUGETLB pool) to cut the TLB
+ * misses of the scattered team moves.
+ * - NUMA Placement (`--numa interleave|partition`): By default every page
+ * lands on the node of the thread that first writes it. `interleave` spreads
+ * the state table over all nodes page by page (even interconnect load for the
+ * work-stealing waves); `partition` puts each node's share of the config range
+ * on that node and pins the pool so the threads working on it run there, which
+ * suits `--owner-computes`. The memory report shows the resident bytes per node.
+ * - Asynchronous Mode (`--async`): Drops the barrier between waves, which 
+ * leaves cores idle at the tail of every wave. Each thread pushes the states 
+ * it resolves onto its own lock-free `WorkStealingQueue` and steals from the 
+ * others when it runs dry, until nothing is queued or in flight. The 
+ * `fetch_or` and countdown ownership tricks still queue every state only once.
+ * - Owner-Computes Mode (`--owner-computes`): Push waves without atomics on 
+ * the state table. Each thread owns a contiguous range of config IDs, cut so 
+ * no word is shared, and expands only the wave states in it. Robber moves stay 
+ * inside a config, so they are applied in place; team moves into another 
+ * range go into a per-destination outbox (after a read to drop the ones 
+ * already won), and each owner then applies its inboxes with plain stores, 
+ * one slice of the ranges at a time so the outboxes stay small. 
+ * The same decomposition a multi-process solver would exchange messages on.
+ * - Vertex Relabelling (`--relabel bfs|rcm`): Renumbers the nodes in BFS or 
+ * reverse Cuthill-McKee order before the adjacency list is built. Neighbours 
+ * get nearby labels, and since the lexicographic config order varies the last 
+ * cop fastest, one cop stepping to a neighbour moves the config ID only a 
+ * little. The answer is mapped back to the file's labels.
+ * - Out-of-Core Mode (`--out-of-core dir`): For tables larger than RAM. The
+ * state planes and frontier live in a sparse, already deleted file in `dir`
+ * (local NVMe) that the kernel pages in and out. Every wave is a push wave,
+ * expanded one block of configs at a time in file order (`--ram-budget MB`
+ * sizes the blocks). Robber moves stay inside the block. Team moves land 
+ * anywhere: those inside the block are applied right away, the rest go to an 
+ * `ExternalFrontier`: per-thread buffers that spill to disk as sorted 
+ * 32/64-bit ID runs, k-way merged after the wave (in extra passes when there 
+ * are too many runs for the budget) and applied in state order. Page faults 
+ * are then sequential, and the table is written back and dropped from RAM 
+ * after every block.
+ * - Checkpoints (`--checkpoint file`, `--resume`): Between waves, every 
+ * `--checkpoint-interval` seconds (and on Ctrl-C, which then stops the solve), 
+ * the state planes, frontier buffers, wave counter and progress totals are 
+ * saved to `file`. Saves alternate between two slots of the file, so a crash 
+ * mid-save leaves the last one whole, and only the pages whose hash changed 
+ * since a slot was last written go to disk. `--resume` carries on after the 
+ * last saved wave. The Profiler report shows what the saves cost.
  * * PERFORMANCE METRICS (on scotlandyard-yellow with 3 cops)
- * - Memory -> 0.33 GB
- * - Time -> 200 seconds
+ * - Memory -> 0.28 GB (peak RSS, no transition budget)
+ * - Time -> 344 seconds (1 thread)
  * ============================================================================
  */
 
 #include "Graph.h"
 #include "AdjacencyList.h"
 #include "copconfig.h"
+#include "TransitionProvider.h"
+#include "CopKernels.h"
 #include "Allocator.h"
+#include "ExternalFrontier.h"
+#include "PackedStateStore.h"
+#include "WaveFrontier.h"
+#include "RobberSet.h"
+#include "ThreadPool.h"
+#include "WorkStealingQueue.h"
+#include "VertexOrdering.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <numeric>
 #include <cstring>
 #include <thread>
 #include <atomic>
 #include <cstdint>
 #include <chrono>
 #include <iomanip>
+#include <string>
+#include <csignal>
 
-// MSB is 1 for Robber's turn, 0 for Cop's turn. 
-// The rest of the bits hold the stateId.
-constexpr size_t ROBBER_TURN_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
-constexpr size_t STATE_ID_MASK = ~ROBBER_TURN_BIT;
+// --- CHECKPOINT COUNTERS ---
+// The progress a checkpoint saves next to the state table and frontier, by index
+enum CheckpointCounter : size_t {
+    CHECKPOINT_PASSES,
+    CHECKPOINT_STATES_PROCESSED,
+    CHECKPOINT_OPEN_COP_STATES,
+    CHECKPOINT_OPEN_ROBBER_STATES,
+    CHECKPOINT_WAVE_SIZE,
+    CHECKPOINT_ROBBER_TURN_SIZE,
+    CHECKPOINT_DENSE,
+    CHECKPOINT_CURRENT_BUFFER,
+    CHECKPOINT_COUNTER_COUNT
+};
 
-// --- STATE BIT-PACKING CONSTANTS (uint8_t) ---
-// We pack everything into 1 byte (std::atomic<uint8_t>)
-// Bit 0: Cop Turn Win
-// Bits 1-7: Robber Safe Moves Counter (Max value 127)
-constexpr uint8_t COP_WIN_BIT      = 1 << 0;
-constexpr uint8_t SAFE_MOVES_SHIFT = 1;
-constexpr uint8_t SAFE_MOVES_MASK  = 0xFE; // 1111 1110
+// --- INTERRUPTS ---
+// Ctrl-C while checkpointing asks for one last checkpoint at the end of the current wave, then a clean stop
+// The handler puts the default back, so a second Ctrl-C still kills the solver straight away
+static volatile std::sig_atomic_t interruptRequested = 0;
+
+void requestInterrupt(int) {
+    interruptRequested = 1;
+    std::signal(SIGINT, SIG_DFL);
+}
 
 // --- PROCEDURAL HELPERS ---
 
 /**
  * Identifies immediate capture states (robber and cop share a node).
- * Flags them, handles the bit-shifted safe moves counter, and pushes 
- * them to the initial wave to kickstart the BFS. Now includes a progress bar.
+ * Flags them, fills in the safe moves counters of every other state, and pushes 
+ * them to the initial wave to kickstart the BFS. Configs are split across the 
+ * pool, and thread 0 keeps the progress bar.
  */
-void initializeCaptures(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
-                        std::atomic<uint8_t>* gameStates, std::vector<size_t>& currentFrontier) {
+void initializeCaptures(size_t configCount, int k, int N, const CopConfigRanker& ranker, const AdjacencyList& adj,
+                        PackedStateStore& states, WaveFrontier& frontier, ThreadPool& pool) {
     
     uint8_t robberDegrees[256];
     for (int r = 0; r < N; ++r) {
@@ -71,44 +179,56 @@ void initializeCaptures(size_t configCount, int k, int N, const uint8_t* configs
         robberDegrees[r] = static_cast<uint8_t>(eCount);
     }
 
-    int initialWins = 0;
+    const size_t INIT_BATCH = 4096;
+    std::atomic<size_t> initialWins{0};
+    std::atomic<size_t> configsDone{0};
     auto lastPrintTime = std::chrono::steady_clock::now();
-    
-    for (size_t cId = 0; cId < configCount; ++cId) {
-        
-        // --- PROGRESS TRACKER ---
-        if (cId % 4096 == 0) {
+
+    pool.parallelFor(configCount, INIT_BATCH, [&](unsigned int tId, size_t startId, size_t endId) {
+
+        // --- PROGRESS TRACKER (Thread 0 Only) ---
+        if (tId == 0) {
             auto now = std::chrono::steady_clock::now();
             if (std::chrono::duration_cast<std::chrono::seconds>(now - lastPrintTime).count() >= 1) {
-                std::cout << "\rInitializing Captures: " << (cId * 100) / configCount << "%" << std::flush;
+                size_t done = configsDone.load(std::memory_order_relaxed);
+                std::cout << "\rInitializing Captures: " << (done * 100) / configCount << "%" << std::flush;
                 lastPrintTime = now;
             }
         }
 
-        const uint8_t* currentCops = &configs[cId * k];
-        
-        for (int r = 0; r < N; ++r) {
-            size_t stateId = cId * N + r;
+        uint8_t currentCops[MAX_COPS];
+        size_t localWins = 0;
+
+        for (size_t cId = startId; cId < endId; ++cId) {
+            ranker.unrank(cId, currentCops);
             
-            bool caught = false;
-            for (int i = 0; i < k; ++i) {
-                if (currentCops[i] == r) {
-                    caught = true;
-                    break;
+            for (int r = 0; r < N; ++r) {
+                size_t stateId = cId * N + r;
+                
+                bool caught = false;
+                for (int i = 0; i < k; ++i) {
+                    if (currentCops[i] == r) {
+                        caught = true;
+                        break;
+                    }
+                }
+                
+                // A capture keeps a safe moves counter of zero, which already marks the Robber's turn as won
+                if (caught) {
+                    states.markCapture(stateId);
+                    frontier.push(stateId, false);
+                    frontier.push(stateId, true);
+                    localWins++;
+                } else {
+                    // Counters of neighbouring batches can share a word, so this has to be the atomic overwrite
+                    states.resetSafeMoves(stateId, robberDegrees[r]);
                 }
-            }
-            
-            if (caught) {
-                gameStates[stateId].store(COP_WIN_BIT, std::memory_order_relaxed);
-                currentFrontier.push_back(stateId);                     
-                currentFrontier.push_back(stateId | ROBBER_TURN_BIT);   
-                initialWins++;
-            } else {
-                uint8_t packedDegree = static_cast<uint8_t>(robberDegrees[r]) << SAFE_MOVES_SHIFT;
-                gameStates[stateId].store(packedDegree, std::memory_order_relaxed);
             }
         }
-    }
+
+        initialWins.fetch_add(localWins, std::memory_order_relaxed);
+        configsDone.fetch_add(endId - startId, std::memory_order_relaxed);
+    });
 
     // Clear the progress line
     std::cout << "\rInitializing Captures: 100% completed.        \n";
@@ -116,9 +236,137 @@ void initializeCaptures(size_t configCount, int k, int N, const uint8_t* configs
     std::cout << "Starting Multi-Threaded Level-Synchronous BFS...\n";
 }
 
+/**
+ * Picks the direction of the next wave, after Beamer's direction-optimising BFS.
+ * Push pays for the team moves out of every Robber turn on the frontier (one row 
+ * per state) and a neighbourhood per Cop turn. Pull pays for one row per config 
+ * that still has an open Cop turn, checked against each of its open robber 
+ * positions until one is lost, a neighbourhood per open Robber turn, and a scan 
+ * of every state to find the open ones. Pull only reads where push does an 
+ * atomic read-modify-write, hence PULL_ADVANTAGE.
+ */
+bool preferPull(const WaveFrontier& frontier, size_t openCopStates, size_t openRobberStates, size_t configCount,
+                size_t numStates, double movesPerConfig, double closedDegree) {
+
+    constexpr double PULL_ADVANTAGE = 2.0;
+    constexpr double CHECK_COST = 0.25; // One robber position checked against one team move, relative to generating the move
+
+    double copFrontier = static_cast<double>(frontier.waveSize - frontier.robberTurnSize);
+    double robberFrontier = static_cast<double>(frontier.robberTurnSize);
+    double pullRows = static_cast<double>(std::min(configCount, openCopStates));
+
+    double pushWork = robberFrontier * movesPerConfig + copFrontier * closedDegree;
+    double pullWork = pullRows * movesPerConfig + openCopStates * movesPerConfig * CHECK_COST + openRobberStates * closedDegree +
+                      static_cast<double>(numStates);
+
+    return pushWork * PULL_ADVANTAGE > pullWork;
+}
+
+/**
+ * Runs the whole retrograde analysis without waves (`--async`), starting from 
+ * the current wave of the frontier (the captures). Every thread works off its 
+ * own lock-free queue, depth first, and steals the oldest item of another 
+ * queue when its own is empty. `pending` counts the states queued or being 
+ * expanded; an expansion adds its children before dropping itself, so it only 
+ * reaches zero once the whole game is solved. Items are stateId << 1 | robberTurn. 
+ * Thread 0 keeps the progress line. Returns the number of states resolved.
+ */
+template <typename Expand>
+size_t runAsyncRetrograde(WaveFrontier& frontier, ThreadPool& pool, size_t totalStateSpace, Expand&& expandState) {
+
+    const size_t QUEUE_CAPACITY = 4096;
+    const size_t COUNT_FLUSH = 1024;
+
+    std::vector<WorkStealingQueue> queues(pool.numThreads);
+    for (WorkStealingQueue& queue : queues) queue.constructFrom(QUEUE_CAPACITY);
+
+    std::atomic<int64_t> pending{static_cast<int64_t>(frontier.waveSize)};
+    std::atomic<size_t> resolved{0};
+
+    // Deal the captures out across the queues
+    pool.parallelFor(frontier.getBatchCount(), 1, [&](unsigned int tId, size_t startBatch, size_t endBatch) {
+        for (size_t batch = startBatch; batch < endBatch; ++batch) {
+            frontier.forEachInBatch(batch, [&](size_t stateId, bool isRobberTurn) {
+                queues[tId].push((static_cast<uint64_t>(stateId) << 1) | static_cast<uint64_t>(isRobberTurn));
+            });
+        }
+    });
+
+    std::cout << "Starting asynchronous retrograde (" << frontier.waveSize << " captures queued)...\n";
+    auto lastPrintTime = std::chrono::steady_clock::now();
+
+    pool.run([&](unsigned int tId) {
+        WorkStealingQueue& own = queues[tId];
+        unsigned int numThreads = pool.numThreads;
+        size_t localResolved = 0;
+        int idleSpins = 0;
+
+        while (true) {
+            uint64_t item;
+            bool found = own.pop(&item);
+            for (unsigned int i = 1; !found && i < numThreads; ++i) {
+                found = queues[(tId + i) % numThreads].steal(&item);
+            }
+
+            if (!found) {
+                if (pending.load(std::memory_order_acquire) == 0) break;
+                if (++idleSpins > 64) std::this_thread::yield();
+                continue;
+            }
+            idleSpins = 0;
+
+            int64_t produced = 0;
+            expandState(static_cast<size_t>(item >> 1), (item & 1) != 0, [&](size_t prevId, bool prevRobberTurn) {
+                own.push((static_cast<uint64_t>(prevId) << 1) | static_cast<uint64_t>(prevRobberTurn));
+                produced++;
+            });
+
+            // Children are already queued, so this never lets pending touch zero early
+            if (produced != 1) pending.fetch_add(produced - 1, std::memory_order_acq_rel);
+
+            // Counts go to the shared total in lumps, it is only read for progress
+            if (++localResolved == COUNT_FLUSH) {
+                resolved.fetch_add(localResolved, std::memory_order_relaxed);
+                localResolved = 0;
+
+                // --- GLOBAL PROGRESS TRACKER (Thread 0 Only) ---
+                if (tId == 0) {
+                    auto now = std::chrono::steady_clock::now();
+                    if (std::chrono::duration_cast<std::chrono::seconds>(now - lastPrintTime).count() >= 1) {
+                        size_t totalProcessed = resolved.load(std::memory_order_relaxed);
+                        double percent = (static_cast<double>(totalProcessed) / totalStateSpace) * 100.0;
+
+                        std::cout << std::fixed << std::setprecision(3);
+                        std::cout << "\r  -> Global Progress: " << percent << "% ("
+                                  << totalProcessed << " / " << totalStateSpace << " states)" << std::flush;
+                        lastPrintTime = now;
+                    }
+                }
+            }
+        }
+
+        resolved.fetch_add(localResolved, std::memory_order_relaxed);
+    });
+
+    // Clear the thread 0 progress line
+    std::cout << "\r  -> Global Progress: complete.                                              \n";
+
+    size_t queueBytes = 0;
+    for (const WorkStealingQueue& queue : queues) queueBytes += queue.getMemoryFootprint();
+    std::cout << "[Memory] async work queues (peak): " << std::fixed << std::setprecision(2)
+              << static_cast<double>(queueBytes) / (1024.0 * 1024.0) << " MB\n";
+
+    return resolved.load(std::memory_order_relaxed);
+}
+
 // --- MAIN ALGORITHM (LEAN MEMORY + PROGRESS TRACKING) ---
 
-void solveCopsAndRobbers(Graph* g, int k) {
+void solveCopsAndRobbers(Graph* g, const VertexOrdering& ordering, int k, size_t budgetMB, bool counterless, bool async,
+                         bool ownerComputes, unsigned int numThreads, bool pinThreads, Allocator::HugePages hugePages,
+                         Allocator::Placement placement, const std::string& outOfCoreDir, size_t ramBudgetMB,
+                         const std::string& checkpointPath, size_t checkpointInterval, bool resume, Profiler* p) {
+
+    p->enter("Setup");
 
     int N = g->nodeCount;
     if (N == 0) {
@@ -129,86 +377,276 @@ void solveCopsAndRobbers(Graph* g, int k) {
     // STEP 1 --- Adjacency List
     AdjacencyList adj(g);
 
-    // STEP 2 --- Cop Configurations
-    size_t configCount;
-    uint8_t* configs = generateCopConfigs(k, N, &configCount);
-    if (!configs || configCount == 0) return;
+    // STEP 2 --- Cop Configuration Ranking (replaces the configs array)
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
+
+    CopConfigRanker ranker(k, N);
+    size_t configCount = ranker.configCount;
+    if (configCount == 0) return;
+
+    double rankerMB = static_cast<double>(ranker.getMemoryFootprint()) / (1024.0 * 1024.0);
+    std::cout << "\n[Memory] config ranker tables: " << std::fixed << std::setprecision(2) << rankerMB << " MB\n";
 
-    double configsMB = static_cast<double>(configCount * k * sizeof(uint8_t)) / (1024.0 * 1024.0);
-    std::cout << "\n[Memory] configs array: " << std::fixed << std::setprecision(2) << configsMB << " MB\n";
+    // The transition cache, capture init and every wave run on these threads
+    ThreadPool pool;
+    pool.constructFrom(numThreads, pinThreads);
+    std::cout << "Thread pool: " << pool.numThreads << " threads";
+    if (pinThreads) std::cout << " (pinned, " << pool.getNodeCount() << " NUMA node" << (pool.getNodeCount() == 1 ? "" : "s") << ")";
+    std::cout << "\n";
 
-    // STEP 3 --- Allocate Game States (Bit-Packed) via Arena Allocator
+    // STEP 2.5 --- Transition Cache (fills the memory budget, everything else is generated on the fly)
+    TransitionProvider transitions;
+    transitions.constructFrom(&adj, &ranker, budgetMB * 1024 * 1024, pool);
+
+    double cacheMB = static_cast<double>(transitions.getMemoryFootprint()) / (1024.0 * 1024.0);
+    std::cout << "[Memory] transition cache: " << std::fixed << std::setprecision(2) << cacheMB << " MB ("
+              << transitions.cachedRows << " / " << configCount << " rows precomputed)\n";
+
+    // STEP 3 --- Allocate Game States (Sub-Byte Packed) via Arena Allocator
     Allocator mem;
-    std::atomic<uint8_t>* gameStates = nullptr;
+    mem.setHugePages(hugePages);
+    bool outOfCore = !outOfCoreDir.empty();
+    if (outOfCore) mem.setBackingDirectory(outOfCoreDir);
+    mem.trackExternal("Transition Cache (Compressed CSR)", transitions.getMemoryFootprint());
     size_t numStates = configCount * N;
 
     std::cout << "Generating ATOMIC states...\n";
     std::cout << "Total States: " << numStates << "\n";
-    
-    mem.requestAlloc("Game States (Bit-Packed)", numStates, &gameStates);
-    mem.allocate();
 
-    // Initialize atomics safely in one perfectly flat pass
-    for (size_t i = 0; i < numStates; ++i) {
-        gameStates[i].store(0, std::memory_order_relaxed);
+    // The robber has at most maxDegree + 1 safe moves (staying put counts)
+    PackedStateStore states;
+    states.constructFrom(numStates, adj.maxDegree + 1, &mem, counterless, placement);
+    std::cout << "[Memory] game states: " << std::fixed << std::setprecision(2) << states.getBitsPerState() << " bits per state\n";
+
+    WaveFrontier frontier;
+    frontier.constructFrom(numStates, &mem, placement);
+
+    double frontierMB = static_cast<double>(frontier.getMemoryFootprint()) / (1024.0 * 1024.0);
+    std::cout << "[Memory] BFS Frontier (bitmap or 32-bit list per wave): " << std::fixed << std::setprecision(2) << frontierMB << " MB\n";
+
+    // STEP 3.5 --- Checkpoint File (the arenas hold the whole state table and frontier, so they are saved whole)
+    Checkpoint checkpoint;
+    bool checkpointing = !checkpointPath.empty();
+    if (checkpointing) {
+        // Ties the file to this team size, table layout and graph (in solving order)
+        uint64_t fingerprint = Checkpoint::hashBytes(&k, sizeof(k), (static_cast<uint64_t>(N) << 1) | counterless);
+        for (int r = 0; r < N; ++r) {
+            uint8_t* edges = adj.getEdges(r);
+            size_t eCount = 1;
+            while (edges[eCount - 1] != 255) eCount++;
+            fingerprint = Checkpoint::hashBytes(edges, eCount, fingerprint);
+        }
+
+        if (!checkpoint.constructFrom(checkpointPath, fingerprint, resume)) {
+            std::cerr << "FATAL: Could not open the checkpoint file " << checkpointPath << ".\n";
+            return;
+        }
+        for (size_t i = 0; i < mem.getArenaCount(); ++i) checkpoint.addRegion(mem.getArenaBase(i), mem.getArenaBytes(i));
+        mem.trackExternal("Checkpoint Page Hashes", checkpoint.getMemoryFootprint());
     }
 
-    std::vector<size_t> currentFrontier;
-    currentFrontier.reserve(10000000); 
 
-    double frontierMB = static_cast<double>(currentFrontier.capacity() * sizeof(size_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] BFS Frontier Queue: " << std::fixed << std::setprecision(2) << frontierMB << " MB\n";
-    
-    mem.print(); // Prints the automatically tracked Allocator pools
+    // STEP 4 --- INITIALIZATION (or the state of the last checkpoint)
+    std::vector<uint64_t> resumed;
+    if (resume) {
+        p->enter("Restore Checkpoint");
+        if (!checkpoint.load(pool, &resumed) || resumed.size() != CHECKPOINT_COUNTER_COUNT) {
+            std::cerr << "FATAL: " << checkpointPath << " holds no complete checkpoint for this graph, team size and settings.\n";
+            return;
+        }
+        frontier.restore(resumed[CHECKPOINT_WAVE_SIZE], resumed[CHECKPOINT_ROBBER_TURN_SIZE], resumed[CHECKPOINT_DENSE] != 0,
+                         static_cast<int>(resumed[CHECKPOINT_CURRENT_BUFFER]));
+        std::cout << "Resumed from " << checkpointPath << " after wave " << resumed[CHECKPOINT_PASSES] << " ("
+                  << frontier.waveSize << " states in the next wave)\n";
+    } else {
+        p->enter("Initialize Captures");
+        initializeCaptures(configCount, k, N, ranker, adj, states, frontier, pool);
+        frontier.advance(pool);
+    }
+    p->enter("Setup");
 
-    // STEP 4 --- INITIALIZATION
-    initializeCaptures(configCount, k, N, configs, adj, gameStates, currentFrontier);
+    mem.print(); // Prints the automatically tracked Allocator pools (after init, so the NUMA section shows touched pages)
+
+    // Out-of-core blocks: as many states as fit the RAM budget across the file-backed planes, cut on 64-state words
+    // Capture init touched the whole table, so it is written back before the first wave
+    outOfCore = outOfCore && mem.hasFileBackedArenas();
+    size_t blockStates = numStates;
+    if (outOfCore) {
+        double bitsPerState = states.getBitsPerState() + 4.0; // State planes plus both frontier buffers
+        blockStates = static_cast<size_t>(static_cast<double>(ramBudgetMB) * 1024.0 * 1024.0 * 8.0 / bitsPerState);
+        blockStates = std::max<size_t>(std::min(blockStates, numStates + 63) & ~(size_t)63, 64);
+        std::cout << "Out-of-core: " << (numStates + blockStates - 1) / blockStates << " block(s) of " << blockStates
+                  << " states (" << ramBudgetMB << " MB budget)\n";
+        mem.releaseResident();
+    }
+
+    // Team moves of an out-of-core wave: a quarter of the RAM budget is buffered, the rest spills as sorted runs
+    ExternalFrontier teamMoves;
+    if (outOfCore && !teamMoves.constructFrom(outOfCoreDir, numStates, pool.numThreads, ramBudgetMB * 1024 * 1024 / 4)) {
+        std::cerr << "FATAL: Could not create a frontier spill file in " << outOfCoreDir << ".\n";
+        return;
+    }
 
     size_t totalStateSpace = configCount * N * 2;
-    size_t statesProcessedPriorWaves = 0;
+    size_t statesProcessedPriorWaves = resume ? resumed[CHECKPOINT_STATES_PROCESSED] : 0;
+    bool interrupted = false;
+
+    // STEP 5 --- MAIN MULTI-THREADED RETROGRADE LOOP (move generation compiled for this k)
+    p->enter("Main Loop");
+    dispatchCopKernel(k, [&](auto kernel) {
+        using Kernel = decltype(kernel);
+
+        // Resolves the predecessors of one newly won state, handing each one this call wins to emit(stateId, robberTurn)
+        auto expandState = [&](size_t stateId, bool isRobberTurn, auto&& emit) {
+            size_t cId = stateId / N;
+            int r = stateId % N;
+
+            if (isRobberTurn) {
+                // Every team move into this config is a previous Cop's turn the cops can win
+                // (moves are reversible, so the forward row doubles as the predecessor list)
+                // Each predecessor config is visited once, so no state is hit twice from here
+                transitions.forEachMove<Kernel::COPS>(cId, [&](size_t prev_cId) {
+                    size_t prevStateId = prev_cId * N + r; 
+                    if (states.markCopTurnWin(prevStateId)) {
+                        emit(prevStateId, false);
+                    }
+                });
+            } 
+            else {
+                size_t stateBase = cId * N;
+
+                auto processRobberMove = [&](int prevR) {
+                    size_t prevId = stateBase + prevR;
+                    bool trapped;
+                    if (states.counterless) {
+                        // No counter to count down: re-check the robber's whole escape set instead
+                        trapped = !states.isRobberTurnWin(prevId) && states.isRobberTrapped(stateBase, prevR, adj) &&
+                                  states.markRobberTurnWin(prevId);
+                    } else {
+                        trapped = states.decrementSafeMoves(prevId);
+                    }
+                    if (trapped) {
+                        emit(prevId, true);
+                    }
+                };
+
+                processRobberMove(r);
+
+                uint8_t* rEdges = adj.getEdges(r);
+                for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
+                    processRobberMove(rEdges[eIdx]);
+                }
+            }
+        };
+
+        if (async) {
+            size_t resolved = runAsyncRetrograde(frontier, pool, totalStateSpace, expandState);
+            std::cout << "Asynchronous retrograde done. States resolved: " << resolved << "\n";
+            return;
+        }
 
-    // STEP 5 --- MAIN MULTI-THREADED RETROGRADE LOOP
-    {
         int passes = 0;
-        unsigned int numThreads = std::thread::hardware_concurrency();
-        if (numThreads == 0) numThreads = 8;
 
-        while (!currentFrontier.empty()) {
+        // Inputs of the push/pull choice: the average row length (from a sample of configs) and closed degree
+        double movesPerConfig = 0.0;
+        size_t sampleStep = std::max<size_t>(1, configCount / 1024);
+        size_t sampleCount = 0;
+        for (size_t cId = 0; cId < configCount; cId += sampleStep) {
+            transitions.forEachMove<Kernel::COPS>(cId, [&](size_t) { movesPerConfig += 1.0; });
+            sampleCount++;
+        }
+        movesPerConfig /= static_cast<double>(sampleCount);
+
+        double closedDegree = 0.0;
+        for (int r = 0; r < N; ++r) {
+            uint8_t* edges = adj.getEdges(r);
+            for (int eIdx = 0; edges[eIdx] != 255; ++eIdx) closedDegree += 1.0;
+        }
+        closedDegree = closedDegree / N + 1.0;
+
+        size_t openCopStates = numStates - (frontier.waveSize - frontier.robberTurnSize);
+        size_t openRobberStates = numStates - frontier.robberTurnSize;
+        if (resume) {
+            passes = static_cast<int>(resumed[CHECKPOINT_PASSES]);
+            openCopStates = resumed[CHECKPOINT_OPEN_COP_STATES];
+            openRobberStates = resumed[CHECKPOINT_OPEN_ROBBER_STATES];
+        }
+
+        // Owner-computes partition: thread t owns the configs [t * configsPerOwner, (t + 1) * configsPerOwner), cut so
+        // that no word of the state table or the frontier is shared between two owners
+        unsigned int numThreads = pool.numThreads;
+        size_t granularity = std::lcm(states.getOwnershipGranularity(), static_cast<size_t>(64));
+        size_t configStep = granularity / std::gcd(granularity, static_cast<size_t>(N));
+        size_t configsPerOwner = (configCount + numThreads - 1) / numThreads;
+        configsPerOwner = ((configsPerOwner + configStep - 1) / configStep) * configStep;
+
+        // outboxes[src * numThreads + dst] holds the Cop turn states src found for dst's range this wave
+        std::vector<std::vector<size_t>> outboxes(ownerComputes ? numThreads * numThreads : 0);
+
+        size_t teamMovesPeakBytes = 0;
+
+        // Saves everything the next wave starts from. Only valid between waves
+        auto lastCheckpointTime = std::chrono::steady_clock::now();
+        auto saveCheckpoint = [&]() {
+            p->enter("Checkpoint Writes");
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<uint64_t> counters(CHECKPOINT_COUNTER_COUNT);
+            counters[CHECKPOINT_PASSES] = passes;
+            counters[CHECKPOINT_STATES_PROCESSED] = statesProcessedPriorWaves;
+            counters[CHECKPOINT_OPEN_COP_STATES] = openCopStates;
+            counters[CHECKPOINT_OPEN_ROBBER_STATES] = openRobberStates;
+            counters[CHECKPOINT_WAVE_SIZE] = frontier.waveSize;
+            counters[CHECKPOINT_ROBBER_TURN_SIZE] = frontier.robberTurnSize;
+            counters[CHECKPOINT_DENSE] = frontier.dense;
+            counters[CHECKPOINT_CURRENT_BUFFER] = static_cast<uint64_t>(frontier.getCurrentBuffer());
+
+            bool saved = checkpoint.save(pool, counters);
+            if (outOfCore) mem.releaseResident(); // Hashing read the whole table back in
+
+            lastCheckpointTime = std::chrono::steady_clock::now();
+            std::chrono::duration<double> seconds = lastCheckpointTime - start;
+            if (saved) {
+                double writtenMB = static_cast<double>(checkpoint.lastWrittenBytes) / (1024.0 * 1024.0);
+                double regionMB = static_cast<double>(checkpoint.getRegionBytes()) / (1024.0 * 1024.0);
+                std::cout << "[Checkpoint] wave " << passes << " saved: " << std::fixed << std::setprecision(2)
+                          << writtenMB << " of " << regionMB << " MB written in " << seconds.count() << " s\n\n";
+            } else {
+                std::cerr << "Warning: Could not write the checkpoint after wave " << passes
+                          << ". The one before it is still intact.\n\n";
+            }
+
+            p->enter("Main Loop");
+        };
+
+        while (frontier.waveSize != 0) {
             passes++;
-            size_t frontierSize = currentFrontier.size();
+            size_t frontierSize = frontier.waveSize;
+            size_t batchCount = frontier.getBatchCount();
+            bool pull = !outOfCore && preferPull(frontier, openCopStates, openRobberStates, configCount, numStates,
+                                   movesPerConfig, closedDegree);
             
-            std::cout << "Starting Wave " << passes << " (" << frontierSize << " states)...\n";
-
-            std::vector<std::vector<size_t>> localNextFrontiers(numThreads);
-            std::vector<std::thread> threads;
+            std::cout << "Starting Wave " << passes << " (" << frontierSize << " states, "
+                      << (pull ? "pull" : (ownerComputes ? "push, owner-computes" : (outOfCore ? "push, out-of-core" :
+                          (frontier.dense ? "push, bitmap" : "push, list"))))
+                      << ")...\n";
             
-            // 1. THE ATOMIC WORK DISPENSER
-            std::atomic<size_t> sharedIndex{0};
-            const size_t BATCH_SIZE = 4096;
-
-            auto worker = [&](unsigned int tId) {
-                // Reserve a generous guess to prevent local reallocations
-                localNextFrontiers[tId].reserve((frontierSize / numThreads) * 2);
-
-                uint8_t options[MAX_COPS][256];
-                int optionCount[MAX_COPS];
-                int odometer[MAX_COPS];
-                uint8_t moveConfig[MAX_COPS];
-                
-                auto lastPrintTime = std::chrono::steady_clock::now();
+            // 1. PUSH: the pool hands out batches of the wave, stealing between threads as they run dry
+            std::atomic<size_t> batchesDone{0};
+            auto lastPrintTime = std::chrono::steady_clock::now();
 
-                // Dynamic Work Loop: Keep grabbing batches until the queue is empty
-                while (true) {
-                    size_t startIdx = sharedIndex.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
-                    if (startIdx >= frontierSize) break;
-                    
-                    size_t endIdx = std::min(startIdx + BATCH_SIZE, frontierSize);
+            auto worker = [&](unsigned int tId, size_t startBatch, size_t endBatch) {
+                for (size_t batch = startBatch; batch < endBatch; ++batch) {
 
                     // --- GLOBAL PROGRESS TRACKER (Thread 0 Only) ---
                     if (tId == 0) {
                         auto now = std::chrono::steady_clock::now();
                         if (std::chrono::duration_cast<std::chrono::seconds>(now - lastPrintTime).count() >= 1) {
-                            size_t totalProcessed = statesProcessedPriorWaves + startIdx;
+                            size_t done = batchesDone.load(std::memory_order_relaxed);
+                            size_t totalProcessed = statesProcessedPriorWaves + (frontierSize * done) / batchCount;
                             double percent = (static_cast<double>(totalProcessed) / totalStateSpace) * 100.0;
                             
                             std::cout << std::fixed << std::setprecision(3);
@@ -218,118 +656,228 @@ void solveCopsAndRobbers(Graph* g, int k) {
                         }
                     }
 
-                    for (size_t q = startIdx; q < endIdx; ++q) {
-                        size_t packedNode = currentFrontier[q];
-                        bool isRobberTurn = (packedNode & ROBBER_TURN_BIT) != 0;
-                        size_t stateId = packedNode & STATE_ID_MASK;
-                        
-                        size_t cId = stateId / N;
-                        int r = stateId % N;
+                    frontier.forEachInBatch(batch, [&](size_t stateId, bool isRobberTurn) {
+                        expandState(stateId, isRobberTurn, [&](size_t prevId, bool prevRobberTurn) {
+                            frontier.push(prevId, prevRobberTurn);
+                        });
+                    });
 
-                        if (isRobberTurn) {
-                            const uint8_t* currentCops = &configs[cId * k];
-                            
-                            // 1. Build movement options for each cop
-                            for (int i = 0; i < k; i++) {
-                                uint8_t u = currentCops[i];
-                                options[i][0] = u; 
-                                int count = 1;
-                                
-                                uint8_t* edges = adj.getEdges(u);
-                                int eIdx = 0;
-                                while (edges[eIdx] != 255) {
-                                    options[i][count++] = edges[eIdx++];
-                                }
-                                optionCount[i] = count;
-                                odometer[i] = 0; 
-                            }
+                    batchesDone.fetch_add(1, std::memory_order_relaxed);
+                }
+            };
 
-                            // 2. Cartesian product to generate all previous configurations
-                            while (true) {
-                                for (int i = 0; i < k; ++i) {
-                                    moveConfig[i] = options[i][odometer[i]];
-                                }
-                                
-                                std::sort(moveConfig, moveConfig + k);
-                                
-                                // 3. Fast-path binary search (No std::memcmp overhead)
-                                size_t prev_cId = static_cast<size_t>(-1); 
-                                size_t left = 0;
-                                size_t right = configCount - 1;
-                                
-                                while (left <= right) {
-                                    size_t mid = left + (right - left) / 2;
-                                    size_t mid_base = mid * k;
-                                    int cmp = 0;
-
-                                    // MAGIC TRICK 3: Unrolled Register Comparison
-                                    if (k == 4) {
-                                        if (configs[mid_base] != moveConfig[0]) cmp = configs[mid_base] < moveConfig[0] ? -1 : 1;
-                                        else if (configs[mid_base + 1] != moveConfig[1]) cmp = configs[mid_base + 1] < moveConfig[1] ? -1 : 1;
-                                        else if (configs[mid_base + 2] != moveConfig[2]) cmp = configs[mid_base + 2] < moveConfig[2] ? -1 : 1;
-                                        else if (configs[mid_base + 3] != moveConfig[3]) cmp = configs[mid_base + 3] < moveConfig[3] ? -1 : 1;
-                                    } else {
-                                        for (int x = 0; x < k; ++x) {
-                                            if (configs[mid_base + x] != moveConfig[x]) {
-                                                cmp = configs[mid_base + x] < moveConfig[x] ? -1 : 1;
-                                                break;
-                                            }
-                                        }
-                                    }
+            // 2. PULL, PHASE A: every config with an open Cop turn generates its row once, and each open robber
+            // position is won by the first team move into a Robber turn the cops have already won
+            const size_t PULL_BATCH = 64;
 
-                                    if (cmp == 0) {
-                                        prev_cId = mid;
-                                        break;
-                                    }
-                                    if (cmp < 0) left = mid + 1;
-                                    else right = mid - 1;
-                                }
-                                
-                                // 4. Process the valid previous state (Uses prev_cId)
-                                if (prev_cId != static_cast<size_t>(-1)) {
-                                    size_t prevStateId = prev_cId * N + r; 
-                                    uint8_t oldVal = gameStates[prevStateId].fetch_or(COP_WIN_BIT, std::memory_order_relaxed);
-                                    if ((oldVal & COP_WIN_BIT) == 0) {
-                                        localNextFrontiers[tId].push_back(prevStateId); 
+            auto copPuller = [&](unsigned int, size_t startId, size_t endId) {
+                for (size_t cId = startId; cId < endId; ++cId) {
+                    size_t stateBase = cId * N;
+
+                    RobberSet open;
+                    open.clear();
+                    for (int r = 0; r < N; ++r) {
+                        if (!states.isCopTurnWin(stateBase + r)) open.set(r);
+                    }
+                    if (open.count() == 0) continue;
+
+                    transitions.forEachMove<Kernel::COPS>(cId, [&](size_t next_cId) {
+                        size_t nextBase = next_cId * N;
+                        for (int w = 0; w < ROBBER_SET_WORDS; ++w) {
+                            uint64_t bits = open.words[w];
+                            while (bits != 0) {
+                                int r = w * 64 + __builtin_ctzll(bits);
+                                bits &= bits - 1;
+                                if (states.isRobberTurnWin(nextBase + r)) {
+                                    open.words[w] &= ~((uint64_t)1 << (r & 63));
+                                    if (states.markCopTurnWin(stateBase + r)) {
+                                        frontier.push(stateBase + r, false);
                                     }
                                 }
-                                
-                                // 5. Advance odometer (Uses odometer and optionCount)
-                                int p = k - 1;
-                                while (p >= 0) {
-                                    odometer[p]++;
-                                    if (odometer[p] < optionCount[p]) break;
-                                    odometer[p] = 0;
-                                    p--;
-                                }
-                                if (p < 0) break;
                             }
-                        } 
-                        else {
-                            auto processRobberMove = [&](size_t prevId) {
-                                uint8_t oldVal = gameStates[prevId].fetch_sub(1 << SAFE_MOVES_SHIFT, std::memory_order_relaxed);
-                                if (((oldVal & SAFE_MOVES_MASK) >> SAFE_MOVES_SHIFT) == 1) {
-                                    localNextFrontiers[tId].push_back(prevId | ROBBER_TURN_BIT); 
-                                }
-                            };
+                        }
+                    });
+                }
+            };
 
-                            processRobberMove(cId * N + r);
+            // 3. PULL, PHASE B: every open Robber turn recounts its safe moves against the Cop turn wins
+            // Wins from phase A still count as safe here, since the push wave that visits them counts them down
+            // (a later pull wave simply recounts)
+            auto robberPuller = [&](unsigned int, size_t startId, size_t endId) {
+                for (size_t cId = startId; cId < endId; ++cId) {
+                    size_t stateBase = cId * N;
 
-                            uint8_t* rEdges = adj.getEdges(r);
-                            for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
-                                processRobberMove(cId * N + rEdges[eIdx]);
+                    for (int r = 0; r < N; ++r) {
+                        size_t stateId = stateBase + r;
+                        if (states.isRobberTurnWin(stateId)) continue;
+
+                        int safeMoves = 0;
+                        auto countMove = [&](int nextR) {
+                            size_t nextId = stateBase + nextR;
+                            if (!states.isCopTurnWin(nextId) || frontier.isPushed(nextId, false)) safeMoves++;
+                        };
+
+                        countMove(r);
+                        uint8_t* rEdges = adj.getEdges(r);
+                        for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
+                            countMove(rEdges[eIdx]);
+                        }
+
+                        if (safeMoves == 0) {
+                            if (states.counterless) states.markRobberTurnWin(stateId);
+                            states.resetSafeMoves(stateId, 0);
+                            frontier.push(stateId, true);
+                        } else {
+                            states.resetSafeMoves(stateId, safeMoves);
+                        }
+                    }
+                }
+            };
+
+            // 4. OWNER-COMPUTES PUSH: each thread expands the wave states in its own configs. Robber moves never leave
+            // the config, so those updates are all local. Team moves into another owner's range are only read
+            // (a shared line, not a stolen one), and the ones still open go to that owner's outbox
+            // Ranges are expanded one slice at a time, with the outboxes emptied in between, to keep them small
+            const size_t OWNER_SLICE_STATES = 64 * 256;
+            size_t slice = 0;
+
+            auto ownerExpander = [&](unsigned int tId) {
+                size_t firstConfig = std::min(static_cast<size_t>(tId) * configsPerOwner, configCount);
+                size_t lastConfig = std::min(firstConfig + configsPerOwner, configCount);
+                size_t sliceBegin = std::min(firstConfig * N + slice * OWNER_SLICE_STATES, lastConfig * N);
+                size_t sliceEnd = std::min(sliceBegin + OWNER_SLICE_STATES, lastConfig * N);
+
+                frontier.forEachInRange(sliceBegin, sliceEnd, [&](size_t stateId, bool isRobberTurn) {
+                    size_t cId = stateId / N;
+                    int r = stateId % N;
+
+                    if (isRobberTurn) {
+                        transitions.forEachMove<Kernel::COPS>(cId, [&](size_t prev_cId) {
+                            size_t prevStateId = prev_cId * N + r;
+                            unsigned int owner = static_cast<unsigned int>(prev_cId / configsPerOwner);
+                            if (owner == tId) {
+                                if (states.markCopTurnWinOwned(prevStateId)) frontier.pushOwned(prevStateId, false);
+                            } else if (!states.isCopTurnWin(prevStateId)) {
+                                outboxes[tId * numThreads + owner].push_back(prevStateId);
+                            }
+                        });
+                    } 
+                    else {
+                        size_t stateBase = cId * N;
+
+                        auto processRobberMove = [&](int prevR) {
+                            size_t prevId = stateBase + prevR;
+                            bool trapped;
+                            if (states.counterless) {
+                                trapped = !states.isRobberTurnWin(prevId) && states.isRobberTrapped(stateBase, prevR, adj) &&
+                                          states.markRobberTurnWinOwned(prevId);
+                            } else {
+                                trapped = states.decrementSafeMovesOwned(prevId);
+                            }
+                            if (trapped) {
+                                frontier.pushOwned(prevId, true);
                             }
+                        };
+
+                        processRobberMove(r);
+
+                        uint8_t* rEdges = adj.getEdges(r);
+                        for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
+                            processRobberMove(rEdges[eIdx]);
                         }
                     }
+                });
+            };
+
+            // Then every owner applies what the others found for it, with plain stores
+            auto ownerApplier = [&](unsigned int tId) {
+                for (unsigned int src = 0; src < numThreads; ++src) {
+                    std::vector<size_t>& inbox = outboxes[src * numThreads + tId];
+                    for (size_t prevStateId : inbox) {
+                        if (states.markCopTurnWinOwned(prevStateId)) frontier.pushOwned(prevStateId, false);
+                    }
+                    inbox.clear();
                 }
             };
 
-            // Spawn the compute threads
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                threads.emplace_back(worker, i);
-            }
-            for (auto& t : threads) {
-                t.join();
+            // 5. OUT-OF-CORE PUSH: the wave is expanded one block at a time, in file order. Cop turns only lead to
+            // robber moves inside their config, which are applied on the spot. Robber turns lead to team moves
+            // anywhere in the table: those landing in the resident block are applied on the spot too, the rest go
+            // to the external frontier (spilling as sorted runs)
+            const size_t OUT_OF_CORE_RANGE_STATES = 64 * 64;
+            const size_t OUT_OF_CORE_APPLY_BATCH = (size_t)1 << 20;
+            size_t blockBegin = 0;
+            size_t blockEnd = 0;
+
+            auto blockExpander = [&](unsigned int tId, size_t startRange, size_t endRange) {
+                size_t rangeBegin = blockBegin + startRange * OUT_OF_CORE_RANGE_STATES;
+                size_t rangeEnd = std::min(blockBegin + endRange * OUT_OF_CORE_RANGE_STATES, blockEnd);
+
+                frontier.forEachInRange(rangeBegin, rangeEnd, [&](size_t stateId, bool isRobberTurn) {
+                    if (isRobberTurn) {
+                        size_t cId = stateId / N;
+                        int r = stateId % N;
+                        transitions.forEachMove<Kernel::COPS>(cId, [&](size_t prev_cId) {
+                            size_t prevStateId = prev_cId * N + r;
+                            if (prevStateId >= blockBegin && prevStateId < blockEnd) {
+                                if (states.markCopTurnWin(prevStateId)) frontier.push(prevStateId, false);
+                            } else {
+                                teamMoves.push(tId, prevStateId);
+                            }
+                        });
+                    } else {
+                        expandState(stateId, false, [&](size_t prevId, bool prevRobberTurn) {
+                            frontier.push(prevId, prevRobberTurn);
+                        });
+                    }
+                });
+            };
+
+            // Then the k-way merge of the runs hands the team moves back in state order, and each batch is applied
+            // in parallel. Every time the merge moves past a block, that block is written back and dropped
+            auto applyTeamMoves = [&](const uint64_t* moves, size_t count) {
+                pool.parallelFor(count, 4096, [&](unsigned int, size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        if (states.markCopTurnWin(moves[i])) frontier.push(moves[i], false);
+                    }
+                });
+
+                if (moves[count - 1] >= blockEnd) {
+                    mem.releaseResident();
+                    blockEnd = (moves[count - 1] / blockStates + 1) * blockStates;
+                }
+            };
+
+            if (pull) {
+                // Phase B reads the Cop turn wins, so phase A has to be finished first
+                pool.parallelFor(configCount, PULL_BATCH, copPuller);
+                pool.parallelFor(configCount, PULL_BATCH, robberPuller);
+                frontier.discard();
+            } else if (ownerComputes) {
+                size_t sliceCount = (configsPerOwner * N + OWNER_SLICE_STATES - 1) / OWNER_SLICE_STATES;
+                for (slice = 0; slice < sliceCount; ++slice) {
+                    pool.run(ownerExpander);
+                    pool.run(ownerApplier);
+                }
+            } else if (outOfCore) {
+                size_t blockCount = (numStates + blockStates - 1) / blockStates;
+
+                for (size_t block = 0; block < blockCount; ++block) {
+                    blockBegin = block * blockStates;
+                    blockEnd = std::min(blockBegin + blockStates, numStates);
+                    std::cout << "\r  -> Out-of-core: expanding block " << block + 1 << " / " << blockCount << std::flush;
+                    pool.parallelFor((blockEnd - blockBegin + OUT_OF_CORE_RANGE_STATES - 1) / OUT_OF_CORE_RANGE_STATES, 1, blockExpander);
+                    mem.releaseResident();
+                }
+
+                teamMovesPeakBytes = std::max(teamMovesPeakBytes, teamMoves.getMemoryFootprint());
+                std::cout << "\r  -> Out-of-core: merging team moves (" << teamMoves.getSpilledRunCount() << " runs spilled)    " << std::flush;
+
+                blockEnd = blockStates;
+                teamMoves.drain(pool, OUT_OF_CORE_APPLY_BATCH, applyTeamMoves);
+                mem.releaseResident();
+            } else {
+                pool.parallelFor(batchCount, 1, worker);
             }
 
             // Clear the thread 0 progress line
@@ -338,41 +886,53 @@ void solveCopsAndRobbers(Graph* g, int k) {
             // Add this wave's size to the running total
             statesProcessedPriorWaves += frontierSize;
 
-            // --- 2. THE PARALLEL MERGE PHASE ---
-            size_t newFrontierSize = 0;
-            std::vector<size_t> threadOffsets(numThreads, 0);
-            
-            // Calculate exact start positions for each thread's chunk
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                threadOffsets[i] = newFrontierSize;
-                newFrontierSize += localNextFrontiers[i].size();
-            }
+            // --- 5. NEXT WAVE ---
+            // Workers already wrote it into the frontier bitmap, this only picks its form (no merge copy)
+            size_t newFrontierSize = frontier.advance(pool);
+            openCopStates -= frontier.waveSize - frontier.robberTurnSize;
+            openRobberStates -= frontier.robberTurnSize;
 
-            // Allocate the exact size needed, all at once
-            currentFrontier.resize(newFrontierSize); 
-            
-            // Lambda for parallel copying
-            auto mergeWorker = [&](unsigned int tId) {
-                if (!localNextFrontiers[tId].empty()) {
-                    std::copy(localNextFrontiers[tId].begin(), 
-                              localNextFrontiers[tId].end(), 
-                              currentFrontier.begin() + threadOffsets[tId]);
-                }
-            };
+            std::cout << "Wave " << passes << " done. New states to process: " << newFrontierSize << "\n\n";
 
-            // Spawn the merge threads
-            threads.clear();
-            for (unsigned int i = 0; i < numThreads; ++i) {
-                threads.emplace_back(mergeWorker, i);
-            }
-            for (auto& t : threads) {
-                t.join();
+            // --- 6. CHECKPOINT ---
+            // Once the interval is up, or right away if Ctrl-C asked the solve to stop here
+            if (checkpointing && newFrontierSize != 0) {
+                std::chrono::duration<double> sinceLast = std::chrono::steady_clock::now() - lastCheckpointTime;
+                if (interruptRequested || sinceLast.count() >= static_cast<double>(checkpointInterval)) saveCheckpoint();
+                if (interruptRequested) {
+                    interrupted = true;
+                    break;
+                }
             }
+        }
 
-            std::cout << "Wave " << passes << " merged. New states to process: " << newFrontierSize << "\n\n";
+        if (outOfCore) {
+            std::cout << "[Memory] out-of-core team move buffers (peak): " << std::fixed << std::setprecision(2)
+                      << static_cast<double>(teamMovesPeakBytes) / (1024.0 * 1024.0) << " MB, spilled "
+                      << teamMoves.totalSpilledRuns << " sorted runs ("
+                      << static_cast<double>(teamMoves.totalSpilledBytes) / (1024.0 * 1024.0) << " MB, "
+                      << (teamMoves.wideIds ? 64 : 32) << "-bit IDs, " << teamMoves.totalMergePasses << " extra merge passes)\n";
         }
+
+        if (ownerComputes) {
+            size_t outboxBytes = 0;
+            for (const std::vector<size_t>& outbox : outboxes) outboxBytes += outbox.capacity() * sizeof(size_t);
+            std::cout << "[Memory] owner-computes outboxes (peak): " << std::fixed << std::setprecision(2)
+                      << static_cast<double>(outboxBytes) / (1024.0 * 1024.0) << " MB\n";
+        }
+    });
+
+    if (checkpointing) {
+        std::cout << "[Checkpoint] " << checkpoint.saveCount << " save(s), " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(checkpoint.totalWrittenBytes) / (1024.0 * 1024.0) << " MB written in total\n";
+    }
+
+    if (interrupted) {
+        std::cout << "\nInterrupted. Run again with --resume to continue from the last checkpoint.\n";
+        return;
     }
 
+    p->enter("Final Verdict Evaluation");
     std::cout << "\n--- FINAL VERDICT ---\n";
     int winningStartConfigId = -1;
 
@@ -380,7 +940,7 @@ void solveCopsAndRobbers(Graph* g, int k) {
         bool universalWin = true;
         for (int rStart = 0; rStart < N; ++rStart) {
             size_t stateId = cId * N + rStart;
-            if (!(gameStates[stateId].load(std::memory_order_relaxed) & COP_WIN_BIT)) {
+            if (!states.isCopTurnWin(stateId)) {
                 universalWin = false;
                 break;
             }
@@ -393,9 +953,14 @@ void solveCopsAndRobbers(Graph* g, int k) {
 
     if (winningStartConfigId != -1) {
         std::cout << "RESULT: WIN. " << k << " Cop(s) CAN win this graph.\n";
+        uint8_t winningCops[MAX_COPS];
+        ranker.unrank(winningStartConfigId, winningCops);
+        uint8_t originalCops[MAX_COPS];
+        ordering.configToOriginal(winningCops, k, originalCops);
+
         std::cout << "Optimal Cop Start Positions: (";
         for (int i = 0; i < k; ++i) {
-            std::cout << (int)configs[winningStartConfigId * k + i] << (i == k - 1 ? "" : ", ");
+            std::cout << (int)originalCops[i] << (i == k - 1 ? "" : ", ");
         }
         std::cout << ")\n";
     } else {
@@ -403,25 +968,139 @@ void solveCopsAndRobbers(Graph* g, int k) {
         std::cout << "(The Robber has a strategy to survive indefinitely against any start).\n";
     }
 
-    delete[] configs;
-    // Allocator handles gameStates automatically
+    // Allocator handles the state planes automatically
 }
 
 // --- ENTRY POINT ---
 int main(int argc, char* argv[]) {
 
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
-        std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+    size_t budgetMB = 0;
+    bool counterless = false;
+    bool async = false;
+    bool ownerComputes = false;
+    unsigned int numThreads = 0;
+    bool pinThreads = false;
+    VertexOrdering::Method relabel = VertexOrdering::Method::ORIGINAL;
+    Allocator::HugePages hugePages = Allocator::HugePages::TRANSPARENT;
+    Allocator::Placement placement = Allocator::Placement::FIRST_TOUCH;
+    std::string outOfCoreDir;
+    size_t ramBudgetMB = 4096;
+    std::string checkpointPath;
+    size_t checkpointInterval = 600;
+    bool resume = false;
+    bool badArgs = (argc < 3);
+    bool budgetSeen = false;
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--counterless") {
+            counterless = true;
+        } else if (arg == "--async") {
+            async = true;
+        } else if (arg == "--owner-computes") {
+            ownerComputes = true;
+        } else if (arg == "--pin-threads") {
+            pinThreads = true;
+        } else if (arg == "--relabel" && i + 1 < argc && VertexOrdering::parseMethod(argv[i + 1], &relabel)) {
+            i++;
+        } else if (arg == "--numa" && i + 1 < argc && Allocator::parsePlacement(argv[i + 1], &placement)) {
+            i++;
+        } else if (arg == "--out-of-core" && i + 1 < argc) {
+            outOfCoreDir = argv[++i];
+        } else if (arg == "--ram-budget" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            ramBudgetMB = std::max<size_t>(std::stoull(argv[++i]), 1);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            checkpointInterval = std::stoull(argv[++i]);
+        } else if (arg == "--resume") {
+            resume = true;
+        } else if (arg == "--huge-pages" && i + 1 < argc && Allocator::parseHugePages(argv[i + 1], &hugePages)) {
+            i++;
+        } else if (arg == "--threads" && i + 1 < argc &&
+                   std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos) {
+            numThreads = static_cast<unsigned int>(std::stoul(argv[++i]));
+        } else if (!budgetSeen && arg.find_first_not_of("0123456789") == std::string::npos) {
+            budgetMB = std::stoull(arg);
+            budgetSeen = true;
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [transition_budget_mb] [--counterless] [--async] [--owner-computes] [--threads n] [--pin-threads] [--relabel m] [--huge-pages p] [--numa p] [--out-of-core dir] [--ram-budget mb] [--checkpoint file] [--checkpoint-interval s] [--resume]\n";
+        std::cout << "Example: " << argv[0] << " graph3.txt 4 2048\n";
+        std::cout << "  --counterless   2 bits per state: re-check robber escapes instead of counting them\n";
+        std::cout << "  --async         no waves: threads share the work through lock-free queues until none is left\n";
+        std::cout << "  --owner-computes each thread owns a range of configs and applies the updates others send it\n";
+        std::cout << "  --threads n     worker threads (default: one per core)\n";
+        std::cout << "  --pin-threads   pin each worker thread to its own core\n";
+        std::cout << "  --relabel m     solve under a cache-friendlier node order: bfs or rcm (default: original)\n";
+        std::cout << "  --huge-pages p  back the state tables with 2 MB pages: none, thp or reserved (default: thp)\n";
+        std::cout << "  --numa p        state table placement: first-touch, interleave or partition (pins threads to match)\n";
+        std::cout << "  --out-of-core d keep the state table in a temporary file in directory d, for tables larger than RAM\n";
+        std::cout << "  --ram-budget mb RAM the out-of-core blocks may use (default: 4096)\n";
+        std::cout << "  --checkpoint f  save the solve to file f between waves (and on Ctrl-C, which then stops it)\n";
+        std::cout << "  --checkpoint-interval s  seconds between checkpoints (default: 600, 0 saves after every wave)\n";
+        std::cout << "  --resume        continue from the last checkpoint in the --checkpoint file\n";
+        return 1;
+    }
+
+    // A partitioned table is only local to the threads if each one stays on the node of its range
+    if (placement == Allocator::Placement::PARTITIONED) pinThreads = true;
+
+    // The escape re-check of counterless mode relies on every earlier wave being finished
+    if (async && counterless) {
+        std::cerr << "Error: --async needs the safe move counters, so it cannot be combined with --counterless.\n";
+        return 1;
+    }
+
+    if (!outOfCoreDir.empty() && (async || ownerComputes)) {
+        std::cerr << "Error: --out-of-core runs its own blocked waves, so it cannot be combined with --async or --owner-computes.\n";
+        return 1;
+    }
+
+    if (async && ownerComputes) {
+        std::cerr << "Error: --owner-computes partitions the waves, so it cannot be combined with --async.\n";
         return 1;
     }
 
+    if (!checkpointPath.empty() && async) {
+        std::cerr << "Error: checkpoints are taken between waves, so --checkpoint cannot be combined with --async.\n";
+        return 1;
+    }
+
+    if (resume && checkpointPath.empty()) {
+        std::cerr << "Error: --resume needs the --checkpoint file to resume from.\n";
+        return 1;
+    }
+
+    if (!checkpointPath.empty()) std::signal(SIGINT, requestInterrupt);
+
+    Profiler p;
+    p.enter("Load Graph");
+
     const char* filename = argv[1];
     int k = std::stoi(argv[2]);
 
     Graph g(filename);
+
+    // Solve on the relabelled graph, every node printed is mapped back to the file's labels
+    VertexOrdering ordering;
+    ordering.constructFrom(&g, relabel);
+    ordering.apply(&g);
+    if (relabel != VertexOrdering::Method::ORIGINAL) {
+        std::cout << "Vertex order: " << ordering.getMethodName() << " (bandwidth " << ordering.bandwidthBefore
+                  << " -> " << ordering.bandwidthAfter << ")\n";
+    }
     
-    solveCopsAndRobbers(&g, k);
+    solveCopsAndRobbers(&g, ordering, k, budgetMB, counterless, async, ownerComputes, numThreads, pinThreads, hugePages, placement,
+                        outOfCoreDir, ramBudgetMB, checkpointPath, checkpointInterval, resume, &p);
+
+    p.print();
 
     return 0;
     
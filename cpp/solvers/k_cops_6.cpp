@@ -0,0 +1,304 @@
+/**
+ * ============================================================================
+ * FILE --- k_cops_6.cpp
+ * ============================================================================
+ * * OVERVIEW
+ * Solves the Cops and Robbers graph game by evaluating every robber position of
+ * a cop configuration at once. It does this using (A) one N-bit `RobberSet` per
+ * cop configuration for each turn instead of one byte per state, (B) precomputed
+ * closed-neighbourhood masks for the robber's turn, and (C) whole-set OR-ing of
+ * successor configurations for the cops' turn.
+ * * DEEPER DIVE
+ * - Bitboard State Table: The state table is indexed `cId * N + r`, so for a fixed
+ * `cId` the robber dimension is contiguous. Here that dimension is collapsed into
+ * the bits of a `RobberSet` (four 64-bit words), making the table 8x smaller
+ * than the byte-per-state table of k_cops_2.
+ * - Robber's Turn: The robber escapes from `r` iff some node in its closed
+ * neighbourhood is not yet a cop win. So the set of escaping positions is the
+ * OR of the closed-neighbourhood masks of every node outside `copTurnWins[cId]`,
+ * and everything else becomes a robber-turn win.
+ * - Cop's Turn: The cops win from `(cId, r)` iff some team move `nextId` has
+ * `(nextId, r)` as a robber-turn win, so `copTurnWins[cId]` is simply the OR of
+ * `robberTurnWins[nextId]` over the CSR row of `cId`. This replaces the per-robber
+ * byte loop with 64-way word operations.
+ * - Ranked CSR: Transitions store plain config IDs (not pre-multiplied by N),
+ * since each one now addresses a whole bitset rather than a single state.
+ * ============================================================================
+ */
+
+#include "Graph.h"
+#include "AdjacencyList.h"
+#include "copconfig.h"
+#include "CopKernels.h"
+#include "RobberSet.h"
+#include "Allocator.h"
+#include "Profiler.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// --- PROCEDURAL HELPERS ---
+
+/**
+ * Builds a Compressed Sparse Row (CSR) table of all team moves, storing the
+ * successor config IDs directly (not multiplied by N).
+ */
+void buildTransitions(size_t configCount, int k, const uint8_t* configs, const CopConfigRanker& ranker, const AdjacencyList& adj,
+                      std::vector<size_t>& outTransitionHeads, std::vector<size_t>& outTransitions) {
+
+    outTransitionHeads.assign(configCount + 1, 0);
+    outTransitions.clear();
+    outTransitions.reserve(configCount * 8);
+
+    std::vector<size_t> tempMoves;
+    tempMoves.reserve(1024);
+
+    dispatchCopKernel(k, [&](auto kernel) {
+        using Kernel = decltype(kernel);
+
+        for (size_t cId = 0; cId < configCount; cId++) {
+            tempMoves.clear();
+            Kernel::forEachTeamMove(&configs[cId * k], k, adj, ranker, [&](size_t nextId) {
+                tempMoves.push_back(nextId);
+            });
+
+            if constexpr (!Kernel::DISTINCT_MOVES) {
+                std::sort(tempMoves.begin(), tempMoves.end());
+                tempMoves.erase(std::unique(tempMoves.begin(), tempMoves.end()), tempMoves.end());
+            }
+
+            outTransitions.insert(outTransitions.end(), tempMoves.begin(), tempMoves.end());
+            outTransitionHeads[cId + 1] = outTransitions.size();
+        }
+    });
+
+    outTransitions.shrink_to_fit();
+
+    std::cout << "Transitions generated. Total edge pointers: " << outTransitions.size() << "\n";
+}
+
+// --- MAIN ALGORITHM ---
+void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
+
+    Allocator mem;
+
+
+    /* --- Load Graph File --- */
+    AdjacencyList adj;
+    {
+        p->enter("Load Graph");
+
+        Graph g(filename);
+
+        if (g.nodeCount == 0) {
+            std::cerr << "Error: Graph is empty or failed to load.\n";
+            return;
+        }
+
+        adj.constructFrom(&g);
+        mem.trackExternal("Graph Adj List", adj.getMemoryFootprint());
+
+        p->enter("Idle");
+    }
+
+    int N = adj.nodeCount;
+
+
+    /* --- Build Transitions --- */
+    size_t configCount = 0;
+    uint8_t* configs = nullptr;
+    CopConfigRanker ranker;
+    std::vector<size_t> transitionHeads;
+    std::vector<size_t> transitions;
+    {
+        p->enter("Build Transitions");
+
+        configs = generateCopConfigs(k, N, &configCount);
+        if (!configs || configCount == 0) {
+            std::cerr << "Error: Unable to generate cop configurations.\n";
+            return;
+        }
+        ranker.constructFrom(k, N);
+
+        buildTransitions(configCount, k, configs, ranker, adj, transitionHeads, transitions);
+
+        mem.trackExternal("Cop Configs", configCount * k);
+        mem.trackExternal("Config Ranker", ranker.getMemoryFootprint());
+        mem.trackExternal("Transitions: Heads", transitionHeads.capacity() * sizeof(size_t), transitionHeads.data());
+        mem.trackExternal("Transitions: Edges", transitions.capacity() * sizeof(size_t), transitions.data());
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Allocate Bitboards --- */
+    RobberSet* copTurnWins = nullptr;
+    RobberSet* robberTurnWins = nullptr;
+    RobberSet* closedNeighbourhoods = nullptr;
+    {
+        p->enter("Allocate Bitboards");
+
+        mem.requestAlloc("Cop Turn Wins (Bitboards)", configCount, &copTurnWins);
+        mem.requestAlloc("Robber Turn Wins (Bitboards)", configCount, &robberTurnWins);
+        mem.requestAlloc("Closed Neighbourhood Masks", N, &closedNeighbourhoods);
+        mem.allocate();
+
+        for (int r = 0; r < N; ++r) {
+            closedNeighbourhoods[r] = RobberSet::closedNeighbourhood(adj, r);
+        }
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Initialize Captures --- */
+    {
+        p->enter("Initialize Captures");
+
+        size_t initialWins = 0;
+        for (size_t cId = 0; cId < configCount; ++cId) {
+
+            // Capture states are wins on both turns: the robber is standing on a cop
+            for (int i = 0; i < k; ++i) {
+                copTurnWins[cId].set(configs[cId * k + i]);
+            }
+            robberTurnWins[cId] = copTurnWins[cId];
+            initialWins += copTurnWins[cId].count();
+        }
+
+        std::cout << "Initialized " << initialWins << " winning states (Captures).\n";
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Main Loop --- */
+    const RobberSet allNodes = RobberSet::full(N);
+    int winningStartConfigId = -1;
+    {
+        p->enter("Main Loop");
+
+        std::cout << "Starting Bitboard Backward Induction Loop...\n";
+
+        int passes = 0;
+        size_t newWinsThisPass;
+        RobberSet escapes;
+        RobberSet copWins;
+
+        while (true) {
+            passes++;
+            newWinsThisPass = 0;
+
+            for (size_t cId = 0; cId < configCount; ++cId) {
+
+                RobberSet& cw = copTurnWins[cId];
+                RobberSet& rw = robberTurnWins[cId];
+
+                // --- RIGHT SIDE: Robber's Turn ---
+                // Any node the cops have not yet won is a safe square, and every
+                // robber position adjacent to (or on) a safe square can escape.
+                if (!(rw == allNodes)) {
+                    escapes.clear();
+                    RobberSet safeSquares = cw.complementWithin(allNodes);
+                    for (int w = 0; w < ROBBER_SET_WORDS; ++w) {
+                        uint64_t bits = safeSquares.words[w];
+                        while (bits) {
+                            int v = (w << 6) + __builtin_ctzll(bits);
+                            escapes |= closedNeighbourhoods[v];
+                            bits &= bits - 1;
+                        }
+                    }
+
+                    int before = rw.count();
+                    rw |= escapes.complementWithin(allNodes);
+                    newWinsThisPass += rw.count() - before;
+                }
+
+                // --- LEFT SIDE: Cop's Turn ---
+                if (!(cw == allNodes)) {
+                    copWins = cw;
+                    for (size_t i = transitionHeads[cId]; i < transitionHeads[cId + 1]; ++i) {
+                        copWins |= robberTurnWins[transitions[i]];
+                        if (copWins == allNodes) break;
+                    }
+
+                    newWinsThisPass += copWins.count() - cw.count();
+                    cw = copWins;
+                }
+
+                // If the cops win from this config against every robber position, we are done
+                if (cw == allNodes) {
+                    winningStartConfigId = cId;
+                    break;
+                }
+            }
+
+            if (winningStartConfigId != -1) {
+                std::cout << "Pass " << passes << ": Optimal capture strategy found!\n";
+                break;
+            }
+
+            std::cout << "Pass " << passes << ": Found " << newWinsThisPass << " new winning states.\n";
+
+            if (newWinsThisPass == 0) break;
+        }
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Find Final Result --- */
+    {
+        p->enter("Final Verdict Evaluation");
+
+        std::cout << "\n--- FINAL VERDICT ---\n";
+
+        if (winningStartConfigId != -1) {
+            std::cout << "RESULT: WIN. " << k << " Cop(s) CAN win this graph.\n";
+            std::cout << "Optimal Cop Start Positions: (";
+            for (int i = 0; i < k; ++i) {
+                std::cout << (int)configs[winningStartConfigId * k + i] << (i == k - 1 ? "" : ", ");
+            }
+            std::cout << ")\n";
+        } else {
+            std::cout << "RESULT: LOSS. " << k << " Cop(s) CANNOT guarantee a win.\n";
+            std::cout << "(The Robber has a strategy to survive indefinitely against any start).\n";
+        }
+
+        p->enter("Idle");
+    }
+
+
+    p->enter("Print Memory Report");
+    mem.print();
+    p->enter("Idle");
+
+    delete[] configs;
+
+    return;
+
+}
+
+// --- ENTRY POINT ---
+int main(int argc, char* argv[]) {
+
+    Profiler p;
+
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+        std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        return 1;
+    }
+
+    const char* filename = argv[1];
+    int k = std::stoi(argv[2]);
+
+    solveCopsAndRobbers(filename, k, &p);
+
+    p.print();
+
+    return 0;
+
+}
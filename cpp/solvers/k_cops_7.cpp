@@ -0,0 +1,319 @@
+/**
+ * ============================================================================
+ * FILE --- k_cops_7.cpp
+ * ============================================================================
+ * * OVERVIEW
+ * Solves the Cops and Robbers graph game without ever enumerating the Cartesian
+ * product of the cops' moves. It does this using (A) a staged decomposition of
+ * the cops' turn into k single-cop moves, (B) the `RobberSet` bitboards from
+ * k_cops_6 for every stage, and (C) combinatorial ranking of each stage's
+ * configurations, so no transition table is stored at all.
+ * * DEEPER DIVE
+ * - Staged Team Moves: A team move is a sequence of k single-cop moves. Stage i
+ * holds the multiset M of the i cops that have already moved and the multiset U
+ * of the k - i cops that have not. Cops are indistinguishable, so the smallest
+ * unmoved cop (U[0]) always moves next; it picks any node of its closed
+ * neighbourhood, which is inserted into M. After stage k - 1 the team move is
+ * complete and it is the robber's turn on config M.
+ * - Existential Layers: The cops win a stage-i state iff some single-cop move
+ * reaches a won stage-(i + 1) state. A cop-turn win therefore propagates through
+ * k layers of fan-out (deg + 1) each instead of one layer of fan-out (deg + 1)^k.
+ * This trades a deg^k factor in transitions for extra states, and many: 
+ * stage i has C(N+i-1, i) * C(N+k-i-1, k-i) configs, so the stages together 
+ * approach 2^k - 1 times the plain game's configs as N grows. On 199 nodes 
+ * that is 6.9x at k = 3, 14.8x at k = 4 and 30x at k = 5.
+ * - Limits: At 32 bytes per set, 4 cops on a 199-node Scotland Yard graph 
+ * need about 30 GB of stage sets (5 cops, over 2 TB), so 4-5 cops there stay 
+ * out of reach for this engine. What it removes is the (deg + 1)^k fan-out 
+ * and the transition table, which makes 3 cops cheap.
+ * - Stage Indexing: Stage i configs are indexed `rank(M) * |U configs| + rank(U)`
+ * using one `CopConfigRanker` per multiset size. Each stage is iterated in
+ * lexicographic order with `nextCopConfig`, so nothing is ever unranked.
+ * - Captures: A cop that lands on the robber mid-turn stays in M, so the capture
+ * is detected at the robber's turn exactly as in the full team-move game.
+ * ============================================================================
+ */
+
+#include "Graph.h"
+#include "AdjacencyList.h"
+#include "copconfig.h"
+#include "RobberSet.h"
+#include "Allocator.h"
+#include "Profiler.h"
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <string>
+
+// --- MAIN ALGORITHM ---
+void solveCopsAndRobbers(const char* filename, int k, Profiler* p) {
+
+    Allocator mem;
+
+
+    /* --- Load Graph File --- */
+    AdjacencyList adj;
+    {
+        p->enter("Load Graph");
+
+        Graph g(filename);
+
+        if (g.nodeCount == 0) {
+            std::cerr << "Error: Graph is empty or failed to load.\n";
+            return;
+        }
+
+        adj.constructFrom(&g);
+        mem.trackExternal("Graph Adj List", adj.getMemoryFootprint());
+
+        p->enter("Idle");
+    }
+
+    int N = adj.nodeCount;
+
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
+
+
+    /* --- Build Stage Layout --- */
+    // rankers[j] ranks multisets of j cops, configCounts[j] is the number of them (configCounts[0] = 1)
+    std::vector<CopConfigRanker> rankers(k + 1);
+    std::vector<size_t> configCounts(k + 1);
+    std::vector<size_t> stageSizes(k);
+    std::vector<RobberSet*> copTurnWins(k, nullptr);
+    RobberSet* robberTurnWins = nullptr;
+    RobberSet* closedNeighbourhoods = nullptr;
+    {
+        p->enter("Build Stage Layout");
+
+        for (int j = 0; j <= k; ++j) {
+            configCounts[j] = countCopConfigs(j, N);
+            if (j > 0) {
+                rankers[j].constructFrom(j, N);
+                mem.trackExternal("Config Ranker (" + std::to_string(j) + " Cops)", rankers[j].getMemoryFootprint());
+            }
+        }
+
+        size_t totalStageConfigs = 0;
+        for (int i = 0; i < k; ++i) {
+            stageSizes[i] = configCounts[i] * configCounts[k - i];
+            totalStageConfigs += stageSizes[i];
+            mem.requestAlloc("Cop Turn Wins (Stage " + std::to_string(i) + ")", stageSizes[i], &copTurnWins[i]);
+        }
+        mem.requestAlloc("Robber Turn Wins", configCounts[k], &robberTurnWins);
+        mem.requestAlloc("Closed Neighbourhood Masks", N, &closedNeighbourhoods);
+        mem.allocate();
+
+        for (int r = 0; r < N; ++r) {
+            closedNeighbourhoods[r] = RobberSet::closedNeighbourhood(adj, r);
+        }
+
+        std::cout << "Team configurations: " << configCounts[k] << "\n";
+        std::cout << "Staged configurations (all " << k << " cop stages): " << totalStageConfigs << "\n";
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Initialize Captures --- */
+    {
+        p->enter("Initialize Captures");
+
+        // Stage 0 is (M = {}, U = config), so its index is simply the config ID
+        uint8_t current[MAX_COPS];
+        std::memset(current, 0, MAX_COPS);
+
+        size_t initialWins = 0;
+        size_t cId = 0;
+        do {
+            for (int i = 0; i < k; ++i) {
+                copTurnWins[0][cId].set(current[i]);
+            }
+            robberTurnWins[cId] = copTurnWins[0][cId];
+            initialWins += copTurnWins[0][cId].count();
+            cId++;
+        } while (nextCopConfig(current, k, N));
+
+        std::cout << "Initialized " << initialWins << " winning states (Captures).\n";
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Main Loop --- */
+    const RobberSet allNodes = RobberSet::full(N);
+    int winningStartConfigId = -1;
+    {
+        p->enter("Main Loop");
+
+        std::cout << "Starting Staged Backward Induction Loop...\n";
+
+        int passes = 0;
+        size_t newWinsThisPass;
+        RobberSet escapes;
+        RobberSet copWins;
+
+        uint8_t moved[MAX_COPS];
+        uint8_t unmoved[MAX_COPS];
+        uint8_t nextMoved[MAX_COPS];
+
+        while (true) {
+            passes++;
+            newWinsThisPass = 0;
+
+            // --- RIGHT SIDE: Robber's Turn (identical to k_cops_6) ---
+            for (size_t cId = 0; cId < configCounts[k]; ++cId) {
+                RobberSet& rw = robberTurnWins[cId];
+                if (rw == allNodes) continue;
+
+                escapes.clear();
+                RobberSet safeSquares = copTurnWins[0][cId].complementWithin(allNodes);
+                for (int w = 0; w < ROBBER_SET_WORDS; ++w) {
+                    uint64_t bits = safeSquares.words[w];
+                    while (bits) {
+                        int v = (w << 6) + __builtin_ctzll(bits);
+                        escapes |= closedNeighbourhoods[v];
+                        bits &= bits - 1;
+                    }
+                }
+
+                int before = rw.count();
+                rw |= escapes.complementWithin(allNodes);
+                newWinsThisPass += rw.count() - before;
+            }
+
+            // --- LEFT SIDE: Cop's Turn, one stage at a time (last mover first) ---
+            for (int stage = k - 1; stage >= 0; --stage) {
+
+                int movedCount = stage;
+                int unmovedCount = k - stage;
+                size_t nextUnmovedConfigs = configCounts[unmovedCount - 1];
+                const CopConfigRanker& nextMovedRanker = rankers[movedCount + 1];
+                RobberSet* stageWins = copTurnWins[stage];
+                RobberSet* nextStageWins = (stage + 1 < k) ? copTurnWins[stage + 1] : robberTurnWins;
+
+                std::memset(moved, 0, MAX_COPS);
+                size_t stageId = 0;
+
+                do {
+                    std::memset(unmoved, 0, MAX_COPS);
+
+                    do {
+                        RobberSet& cw = stageWins[stageId++];
+                        if (cw == allNodes) continue;
+
+                        // The rest of U is unchanged by this single-cop move
+                        size_t tailRank = (unmovedCount > 1) ? rankers[unmovedCount - 1].rank(&unmoved[1]) : 0;
+
+                        copWins = cw;
+
+                        uint8_t mover = unmoved[0];
+                        const RobberSet& moves = closedNeighbourhoods[mover];
+                        for (int w = 0; w < ROBBER_SET_WORDS; ++w) {
+                            uint64_t bits = moves.words[w];
+                            while (bits) {
+                                uint8_t v = static_cast<uint8_t>((w << 6) + __builtin_ctzll(bits));
+                                bits &= bits - 1;
+
+                                // Insert v into the sorted moved multiset
+                                int pos = 0;
+                                while (pos < movedCount && moved[pos] <= v) {
+                                    nextMoved[pos] = moved[pos];
+                                    pos++;
+                                }
+                                nextMoved[pos] = v;
+                                for (int i = pos; i < movedCount; ++i) {
+                                    nextMoved[i + 1] = moved[i];
+                                }
+
+                                size_t nextId = nextMovedRanker.rank(nextMoved) * nextUnmovedConfigs + tailRank;
+                                copWins |= nextStageWins[nextId];
+                            }
+                        }
+
+                        newWinsThisPass += copWins.count() - cw.count();
+                        cw = copWins;
+
+                    } while (nextCopConfig(unmoved, unmovedCount, N));
+
+                } while (nextCopConfig(moved, movedCount, N));
+            }
+
+            // If the cops win from some config against every robber position, we are done
+            for (size_t cId = 0; cId < configCounts[k]; ++cId) {
+                if (copTurnWins[0][cId] == allNodes) {
+                    winningStartConfigId = cId;
+                    break;
+                }
+            }
+
+            if (winningStartConfigId != -1) {
+                std::cout << "Pass " << passes << ": Optimal capture strategy found!\n";
+                break;
+            }
+
+            std::cout << "Pass " << passes << ": Found " << newWinsThisPass << " new winning states.\n";
+
+            if (newWinsThisPass == 0) break;
+        }
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Find Final Result --- */
+    {
+        p->enter("Final Verdict Evaluation");
+
+        std::cout << "\n--- FINAL VERDICT ---\n";
+
+        if (winningStartConfigId != -1) {
+            uint8_t winningCops[MAX_COPS];
+            rankers[k].unrank(winningStartConfigId, winningCops);
+
+            std::cout << "RESULT: WIN. " << k << " Cop(s) CAN win this graph.\n";
+            std::cout << "Optimal Cop Start Positions: (";
+            for (int i = 0; i < k; ++i) {
+                std::cout << (int)winningCops[i] << (i == k - 1 ? "" : ", ");
+            }
+            std::cout << ")\n";
+        } else {
+            std::cout << "RESULT: LOSS. " << k << " Cop(s) CANNOT guarantee a win.\n";
+            std::cout << "(The Robber has a strategy to survive indefinitely against any start).\n";
+        }
+
+        p->enter("Idle");
+    }
+
+
+    p->enter("Print Memory Report");
+    mem.print();
+    p->enter("Idle");
+
+    return;
+
+}
+
+// --- ENTRY POINT ---
+int main(int argc, char* argv[]) {
+
+    Profiler p;
+
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+        std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        return 1;
+    }
+
+    const char* filename = argv[1];
+    int k = std::stoi(argv[2]);
+
+    solveCopsAndRobbers(filename, k, &p);
+
+    p.print();
+
+    return 0;
+
+}
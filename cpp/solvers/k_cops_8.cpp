@@ -0,0 +1,392 @@
+/**
+ * ============================================================================
+ * FILE --- k_cops_8.cpp
+ * ============================================================================
+ * * OVERVIEW
+ * Solves the Cops and Robbers graph game on the quotient of the state space by
+ * the graph's automorphism group. It does this using (A) an `AutomorphismGroup`
+ * computed from the graph (or generated from a user-supplied generator file),
+ * (B) a state table holding only one canonical representative per orbit of
+ * (cop multiset, robber) states, and (C) queue-based retrograde analysis with
+ * every predecessor mapped through canonicalisation.
+ * * DEEPER DIVE
+ * - Canonical States: The robber is mapped to the smallest node of its orbit,
+ * and the cops to the lexicographically smallest sorted image over every
+ * automorphism that does so. Symmetric states share one table entry, cutting
+ * memory and time by up to |Aut(G)| (120 for Petersen, 200 for cycle100).
+ * - Rank Bitmap Index: Canonical states are flagged in a bitmap over
+ * `orbit * configCount + cId` with a running prefix count per 64-bit word, so a
+ * canonical state's dense index is one popcount away (2 bits per slot).
+ * - Counterless Robber Side: A safe-move counter cannot be maintained on the
+ * quotient (several robber moves may land in the same orbit), so when a
+ * cop-turn state is won each robber-turn predecessor simply re-checks its
+ * closed neighbourhood against the cop-turn wins.
+ * - Cop Side: The cops' moves are symmetric (u can reach v iff v can reach u),
+ * so the predecessors of a robber-turn win are generated with the usual
+ * odometer over the cops' closed neighbourhoods, then canonicalised.
+ * ============================================================================
+ */
+
+#include "Graph.h"
+#include "AdjacencyList.h"
+#include "AutomorphismGroup.h"
+#include "copconfig.h"
+#include "Allocator.h"
+#include "Profiler.h"
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <string>
+
+// --- BIT-PACKING CONSTANTS ---
+// MSB is 1 for Robber's turn, 0 for Cop's turn.
+// The rest of the bits hold the canonical slot (orbit * configCount + cId).
+constexpr size_t ROBBER_TURN_BIT = (size_t)1 << (sizeof(size_t) * 8 - 1);
+constexpr size_t SLOT_MASK = ~ROBBER_TURN_BIT;
+
+// --- DP STATE DEFINITION ---
+constexpr uint8_t COP_WIN_BIT = 1 << 0;
+constexpr uint8_t ROB_WIN_BIT = 1 << 1;
+
+// Largest automorphism group we are willing to enumerate explicitly
+constexpr size_t MAX_GROUP_ORDER = 100000;
+
+// --- CANONICAL INDEX ---
+struct CanonicalIndex {
+    size_t configCount;
+    uint64_t* bits;
+    size_t* prefix;
+
+    // Maps a canonical slot to its dense state index
+    inline size_t getIndex(size_t slot) const {
+        size_t w = slot >> 6;
+        uint64_t below = bits[w] & (((uint64_t)1 << (slot & 63)) - 1);
+        return prefix[w] + __builtin_popcountll(below);
+    }
+};
+
+// --- MAIN ALGORITHM ---
+void solveCopsAndRobbers(const char* filename, int k, const char* generatorFile, Profiler* p) {
+
+    Allocator mem;
+
+
+    /* --- Load Graph File & Automorphisms --- */
+    AdjacencyList adj;
+    AutomorphismGroup group;
+    {
+        p->enter("Load Graph");
+
+        Graph g(filename);
+
+        if (g.nodeCount == 0) {
+            std::cerr << "Error: Graph is empty or failed to load.\n";
+            return;
+        }
+
+        adj.constructFrom(&g);
+        mem.trackExternal("Graph Adj List", adj.getMemoryFootprint());
+
+        p->enter("Compute Automorphisms");
+
+        if (generatorFile != nullptr) {
+            group.constructFromGenerators(&g, generatorFile, MAX_GROUP_ORDER);
+        } else {
+            group.constructFrom(&g, MAX_GROUP_ORDER);
+        }
+        mem.trackExternal("Automorphism Group", group.getMemoryFootprint());
+
+        std::cout << "Automorphism group order: " << group.order << " (" << group.orbitCount << " robber orbit(s))\n";
+
+        p->enter("Idle");
+    }
+
+    int N = adj.nodeCount;
+
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
+
+    CopConfigRanker ranker(k, N);
+    size_t configCount = ranker.configCount;
+    mem.trackExternal("Config Ranker", ranker.getMemoryFootprint());
+
+    std::vector<int> orbitNodes;
+    std::vector<int> orbitOf(N, -1);
+    for (int v = 0; v < N; ++v) {
+        if (group.getOrbitRep(v) == v) {
+            orbitOf[v] = static_cast<int>(orbitNodes.size());
+            orbitNodes.push_back(v);
+        }
+    }
+
+
+    /* --- Enumerate Canonical States --- */
+    CanonicalIndex index;
+    size_t canonicalCount = 0;
+    {
+        p->enter("Enumerate Canonical States");
+
+        size_t slotCount = orbitNodes.size() * configCount;
+        size_t wordCount = (slotCount + 63) / 64 + 1;
+
+        index.configCount = configCount;
+        mem.requestAlloc("Canonical Bitmap", wordCount, &index.bits);
+        mem.requestAlloc("Canonical Prefix Counts", wordCount, &index.prefix);
+        mem.allocate();
+
+        for (size_t o = 0; o < orbitNodes.size(); ++o) {
+            uint8_t current[MAX_COPS];
+            std::memset(current, 0, MAX_COPS);
+            size_t cId = 0;
+            do {
+                if (group.isCanonical(current, k, orbitNodes[o])) {
+                    size_t slot = o * configCount + cId;
+                    index.bits[slot >> 6] |= (uint64_t)1 << (slot & 63);
+                }
+                cId++;
+            } while (nextCopConfig(current, k, N));
+        }
+
+        for (size_t w = 0; w < wordCount; ++w) {
+            index.prefix[w] = canonicalCount;
+            canonicalCount += __builtin_popcountll(index.bits[w]);
+        }
+
+        size_t fullCount = configCount * N;
+        std::cout << "Canonical states: " << canonicalCount << " of " << fullCount
+                  << " (" << static_cast<double>(fullCount) / canonicalCount << "x reduction)\n";
+
+        p->enter("Idle");
+    }
+
+    // Maps any (config, r) to the dense index of its canonical state (slot optionally returned)
+    uint8_t canonBuf[MAX_COPS];
+    auto canonicalState = [&](const uint8_t* config, int r, size_t* outSlot) {
+        int rep = group.canonicalize(config, k, r, canonBuf);
+        size_t slot = orbitOf[rep] * configCount + ranker.rank(canonBuf);
+        if (outSlot) *outSlot = slot;
+        return index.getIndex(slot);
+    };
+
+
+    /* --- Allocate States & Queue --- */
+    uint8_t* states = nullptr;
+    size_t* workQueue = nullptr;
+    {
+        p->enter("Memory Allocation");
+
+        mem.requestAlloc("Canonical State Data", canonicalCount, &states);
+        mem.requestAlloc("Analysis Work Queue", canonicalCount * 2, &workQueue);
+        mem.allocate();
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Initialize Captures --- */
+    size_t qWriteHead = 0;
+    size_t qReadHead = 0;
+    {
+        p->enter("Initialize Captures");
+
+        size_t initialWins = 0;
+        for (size_t o = 0; o < orbitNodes.size(); ++o) {
+            int r = orbitNodes[o];
+            uint8_t current[MAX_COPS];
+            std::memset(current, 0, MAX_COPS);
+            size_t cId = 0;
+            do {
+                size_t slot = o * configCount + cId;
+                cId++;
+
+                if (!((index.bits[slot >> 6] >> (slot & 63)) & 1)) continue;
+
+                bool caught = false;
+                for (int i = 0; i < k; ++i) {
+                    if (current[i] == r) { caught = true; break; }
+                }
+
+                if (caught) {
+                    states[index.getIndex(slot)] = COP_WIN_BIT | ROB_WIN_BIT;
+                    workQueue[qWriteHead++] = slot;                     // Cop's turn (MSB 0)
+                    workQueue[qWriteHead++] = slot | ROBBER_TURN_BIT;   // Robber's turn (MSB 1)
+                    initialWins++;
+                }
+            } while (nextCopConfig(current, k, N));
+        }
+
+        std::cout << "Initialized " << initialWins << " canonical winning states (Captures).\n";
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Main Retrograde Loop --- */
+    {
+        p->enter("Backward Induction (Queue Loop)");
+
+        uint8_t options[MAX_COPS][256];
+        int optionCount[MAX_COPS];
+        int odometer[MAX_COPS];
+        uint8_t moveConfig[MAX_COPS];
+        uint8_t currentCops[MAX_COPS];
+        uint8_t prevCops[MAX_COPS];
+
+        while (qReadHead < qWriteHead) {
+
+            size_t packedNode = workQueue[qReadHead++];
+            bool isRobberTurn = (packedNode & ROBBER_TURN_BIT) != 0;
+            size_t slot = packedNode & SLOT_MASK;
+
+            size_t cId = slot % configCount;
+            int r = orbitNodes[slot / configCount];
+            ranker.unrank(cId, currentCops);
+
+            if (isRobberTurn) {
+                // STATE: Cops won, and it was the Robber's turn.
+                // LOGIC: Every cop configuration that can move here wins on its turn.
+
+                for (int i = 0; i < k; i++) {
+                    uint8_t u = currentCops[i];
+                    options[i][0] = u;
+                    int count = 1;
+                    uint8_t* edges = adj.getEdges(u);
+                    int eIdx = 0;
+                    while (edges[eIdx] != 255) options[i][count++] = edges[eIdx++];
+                    optionCount[i] = count;
+                    odometer[i] = 0;
+                }
+
+                while (true) {
+                    for (int i = 0; i < k; ++i) moveConfig[i] = options[i][odometer[i]];
+
+                    size_t prevSlot;
+                    size_t prevIdx = canonicalState(moveConfig, r, &prevSlot);
+                    if (!(states[prevIdx] & COP_WIN_BIT)) {
+                        states[prevIdx] |= COP_WIN_BIT;
+                        workQueue[qWriteHead++] = prevSlot; // Push Cop's turn (MSB 0)
+                    }
+
+                    int slot = k - 1;
+                    while (slot >= 0) {
+                        odometer[slot]++;
+                        if (odometer[slot] < optionCount[slot]) break;
+                        odometer[slot] = 0;
+                        slot--;
+                    }
+                    if (slot < 0) break;
+                }
+            }
+            else {
+                // STATE: Cops won, and it was the Cops' turn.
+                // LOGIC: Each robber position that could step here re-checks whether it still has an escape.
+
+                auto processRobberMove = [&](int rPrev) {
+                    size_t prevSlot;
+                    size_t prevIdx = canonicalState(currentCops, rPrev, &prevSlot);
+                    if (states[prevIdx] & ROB_WIN_BIT) return;
+
+                    // Re-check the canonical representative's closed neighbourhood
+                    size_t prevCId = prevSlot % configCount;
+                    int prevR = orbitNodes[prevSlot / configCount];
+                    ranker.unrank(prevCId, prevCops);
+
+                    if (!(states[canonicalState(prevCops, prevR, nullptr)] & COP_WIN_BIT)) return;
+                    uint8_t* escapes = adj.getEdges(prevR);
+                    for (int eIdx = 0; escapes[eIdx] != 255; eIdx++) {
+                        if (!(states[canonicalState(prevCops, escapes[eIdx], nullptr)] & COP_WIN_BIT)) return;
+                    }
+
+                    states[prevIdx] |= ROB_WIN_BIT;
+                    workQueue[qWriteHead++] = prevSlot | ROBBER_TURN_BIT; // Push Robber's turn (MSB 1)
+                };
+
+                // 1. Robber stayed in place
+                processRobberMove(r);
+
+                // 2. Robber moved from an adjacent node
+                uint8_t* rEdges = adj.getEdges(r);
+                for (int eIdx = 0; rEdges[eIdx] != 255; eIdx++) {
+                    processRobberMove(rEdges[eIdx]);
+                }
+            }
+        }
+
+        std::cout << "Queue empty. Processed " << qWriteHead << " winning state propagations.\n";
+
+        p->enter("Idle");
+    }
+
+
+    /* --- Find Final Result --- */
+    {
+        p->enter("Final Verdict Evaluation");
+
+        std::cout << "\n--- FINAL VERDICT ---\n";
+
+        uint8_t current[MAX_COPS];
+        std::memset(current, 0, MAX_COPS);
+        bool found = false;
+
+        do {
+            bool universalWin = true;
+            for (int rStart = 0; rStart < N; ++rStart) {
+                if (!(states[canonicalState(current, rStart, nullptr)] & COP_WIN_BIT)) {
+                    universalWin = false;
+                    break;
+                }
+            }
+            if (universalWin) {
+                found = true;
+                break;
+            }
+        } while (nextCopConfig(current, k, N));
+
+        if (found) {
+            std::cout << "RESULT: WIN. " << k << " Cop(s) CAN win this graph.\n";
+            std::cout << "Optimal Cop Start Positions: (";
+            for (int i = 0; i < k; ++i) {
+                std::cout << (int)current[i] << (i == k - 1 ? "" : ", ");
+            }
+            std::cout << ")\n";
+        } else {
+            std::cout << "RESULT: LOSS. " << k << " Cop(s) CANNOT guarantee a win.\n";
+            std::cout << "(The Robber has a strategy to survive indefinitely against any start).\n";
+        }
+
+        p->enter("Idle");
+    }
+
+
+    p->enter("Print Memory Report");
+    mem.print();
+    p->enter("Idle");
+
+    return;
+
+}
+
+// --- ENTRY POINT ---
+int main(int argc, char* argv[]) {
+
+    Profiler p;
+
+    if (argc != 3 && argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [generators.txt]\n";
+        std::cout << "Example: " << argv[0] << " graph3.txt 4\n";
+        return 1;
+    }
+
+    const char* filename = argv[1];
+    int k = std::stoi(argv[2]);
+    const char* generatorFile = (argc == 4) ? argv[3] : nullptr;
+
+    solveCopsAndRobbers(filename, k, generatorFile, &p);
+
+    p.print();
+
+    return 0;
+
+}
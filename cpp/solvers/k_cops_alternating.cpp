@@ -11,6 +11,7 @@
 #include "Graph.h"
 #include "AdjacencyList.h"
 #include "copconfig.h"
+#include "TransitionCache.h"
 #include "Allocator.h"
 #include <iostream>
 #include <vector>
@@ -42,102 +43,43 @@ bool check_RobberHiddenNode(int r1, int k, size_t cId, int N, const uint8_t* con
     return true; 
 }
 
-void buildTransitions(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
-                      size_t*& outTransitionHeads, size_t*& outTransitions) {
-    outTransitionHeads = new size_t[configCount + 1];
-    outTransitionHeads[0] = 0;
-    
-    std::vector<size_t> tempAllTransitions; 
-    std::vector<size_t> tempMoves;
-
-    uint8_t options[MAX_COPS][256];
-    int optionCount[MAX_COPS];
-    int odometer[MAX_COPS];
-    uint8_t moveConfig[MAX_COPS];
-
-    for (size_t cId = 0; cId < configCount; cId++) {
-        tempMoves.clear(); 
-        const uint8_t* currentCops = &configs[cId * k];
-        
-        for (int i = 0; i < k; i++) {
-            uint8_t u = currentCops[i];
-            options[i][0] = u; 
-            int count = 1;
-            uint8_t* edges = adj.getEdges(u);
-            int eIdx = 0;
-            // FIX: Bounded check prevents reading past node's allocated slot
-            while (eIdx < adj.maxDegree && edges[eIdx] != 255) {
-                options[i][count++] = edges[eIdx++];
-            }
-            optionCount[i] = count;
-        }
-
-        memset(odometer, 0, MAX_COPS * sizeof(int));
-        
-        while (true) {
-            for (int i = 0; i < k; ++i) moveConfig[i] = options[i][odometer[i]];
-            std::sort(moveConfig, moveConfig + k);
-            
-            size_t nextId = static_cast<size_t>(-1); 
-            size_t left = 0, right = configCount - 1;
-            while (left <= right) {
-                size_t mid = left + (right - left) / 2;
-                int cmp = std::memcmp(&configs[mid * k], moveConfig, k);
-                if (cmp == 0) { nextId = mid; break; }
-                if (cmp < 0) left = mid + 1;
-                else right = mid - 1;
-            }
-            
-            if (nextId != static_cast<size_t>(-1)) {
-                tempMoves.push_back(nextId); // Note: Alternating does not pre-multiply by N here
-            }
-            
-            int p = k - 1;
-            while (p >= 0) {
-                odometer[p]++;
-                if (odometer[p] < optionCount[p]) break;
-                odometer[p] = 0; p--;
-            }
-            if (p < 0) break;
-        }
-
-        std::sort(tempMoves.begin(), tempMoves.end());
-        tempMoves.erase(std::unique(tempMoves.begin(), tempMoves.end()), tempMoves.end());
-        
-        tempAllTransitions.insert(tempAllTransitions.end(), tempMoves.begin(), tempMoves.end());
-        outTransitionHeads[cId + 1] = tempAllTransitions.size();
-    }
-
-    outTransitions = new size_t[tempAllTransitions.size()];
-    std::memcpy(outTransitions, tempAllTransitions.data(), tempAllTransitions.size() * sizeof(size_t));
-}
-
 // --- MAIN ENGINE ---
-void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
+void solveCopsAndRobbers(Graph* g, int k, const char* filename, const char* cacheDir) {
     int N = g->nodeCount;
     if (N == 0) return;
 
     AdjacencyList adj(g);
 
-    size_t configCount;
-    uint8_t* configs = generateCopConfigs(k, N, &configCount);
-    if (!configs) return;
-    
-    double configsMB = static_cast<double>(configCount * k * sizeof(uint8_t)) / (1024.0 * 1024.0);
-    std::cout << "\n[Memory] configs array: " << std::fixed << std::setprecision(2) << configsMB << " MB\n";
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
 
-    size_t* transitionHeads = nullptr;
-    size_t* transitions = nullptr;
-    buildTransitions(configCount, k, N, configs, adj, transitionHeads, transitions);
+    CopConfigRanker ranker(k, N);
+    size_t configCount = ranker.configCount;
+    if (configCount == 0) return;
 
-    size_t totalTransitions = transitionHeads[configCount];
-    double transitionsMB = static_cast<double>((configCount + 1 + totalTransitions) * sizeof(size_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] transitions CSR: " << std::fixed << std::setprecision(2) << transitionsMB << " MB\n";
+    // Configs + CSR transitions, mapped from disk when an earlier run left them behind
+    Allocator mem;
+    TransitionCache table;
+    std::string cacheFile = TransitionCache::getDefaultPath(cacheDir, filename, k);
+    if (!table.constructFrom(&adj, &ranker, cacheFile.c_str(), &mem)) return;
+    if (table.loadedFromDisk) mem.trackExternal("Transition Cache (Mapped)", table.getMappedBytes());
+    const uint8_t* configs = table.configs;
+    const CompressedTransitions& transitions = table.transitions;
+
+    double tableMB = static_cast<double>(table.getMemoryFootprint()) / (1024.0 * 1024.0);
+    double mappedMB = static_cast<double>(table.getMappedBytes()) / (1024.0 * 1024.0);
+    double uncompressedMB = static_cast<double>(transitions.getUncompressedFootprint()) / (1024.0 * 1024.0);
+    std::cout << "\n[Memory] configs + transitions CSR (heap): " << std::fixed << std::setprecision(2) << tableMB << " MB ("
+              << mappedMB << " MB mapped, " << uncompressedMB << " MB uncompressed)\n";
+
+    // Scratch row for the decoded team moves of one configuration (as state offsets, nextId * N)
+    std::vector<size_t> copTrans(transitions.maxRowLength);
 
     size_t numStates = configCount * N;
 
     // Allocate the DP table via Arena Allocator
-    Allocator mem;
     int* col1 = nullptr;
     int* col2 = nullptr;
     int* col3 = nullptr;
@@ -151,11 +93,13 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
     mem.allocate();
     mem.print(); // Display the combined footprint of the DP tables
 
-    // Initialize to -1 (overwriting the Allocator's 0-fill)
-    std::fill_n(col1, numStates, -1);
-    std::fill_n(col2, numStates, -1);
-    std::fill_n(col3, numStates, -1);
-    std::fill_n(col4, numStates, -1);
+    // Initialize to -1 (overwriting the Allocator's 0-fill), in parallel so the first touch of each page is spread out
+    ThreadPool fillPool;
+    fillPool.constructFrom(0);
+    Allocator::fill(col1, numStates, -1, &fillPool);
+    Allocator::fill(col2, numStates, -1, &fillPool);
+    Allocator::fill(col3, numStates, -1, &fillPool);
+    Allocator::fill(col4, numStates, -1, &fillPool);
 
     std::vector<size_t> up1, up2, up3, up4;
     up1.reserve(numStates); up2.reserve(numStates); 
@@ -192,8 +136,7 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
         up1.clear(); up2.clear(); up3.clear(); up4.clear();
 
         for (size_t cId = 0; cId < configCount; ++cId) {
-            size_t copTransStart = transitionHeads[cId];
-            size_t copTransEnd = transitionHeads[cId + 1];
+            size_t copTransCount = transitions.decodeRow(cId, copTrans.data(), N);
 
             for (int r0 = 0; r0 < N; ++r0) {
                 size_t stateId = cId * N + r0;
@@ -221,8 +164,8 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
 
                 // --- 2. Evaluate Col 3 (Depends on Col 4) ---
                 if (col3[stateId] == -1) {
-                    for (size_t i = copTransStart; i < copTransEnd; ++i) {
-                        if (col4[transitions[i] * N + r0] != -1) {
+                    for (size_t i = 0; i < copTransCount; ++i) {
+                        if (col4[copTrans[i] + r0] != -1) {
                             up3.push_back(stateId); break;
                         }
                     }
@@ -235,8 +178,8 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
 
                 // --- 4. Evaluate Col 1 (Depends on Col 2) ---
                 if (col1[stateId] == -1) {
-                    for (size_t i = copTransStart; i < copTransEnd; ++i) {
-                        if (col2[transitions[i] * N + r0] != -1) {
+                    for (size_t i = 0; i < copTransCount; ++i) {
+                        if (col2[copTrans[i] + r0] != -1) {
                             up1.push_back(stateId); break;
                         }
                     }
@@ -327,18 +270,30 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
     }
 
     // --- CLEANUP ---
-    delete[] configs; 
-    delete[] transitionHeads; 
-    delete[] transitions;
+    // TransitionCache releases the configs and transitions
     // Allocator automatically deletes col1, col2, col3, col4!
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+    const char* cacheDir = nullptr;
+    bool badArgs = (argc < 3);
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--transition-cache") {
+            cacheDir = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) ? argv[++i] : "transition_cache";
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [--transition-cache [d]]\n";
+        std::cout << "  --transition-cache [d] keep the transition table in directory d for later runs (default: transition_cache)\n";
         return 1;
     }
+
     Graph g(argv[1]);
-    solveCopsAndRobbers(&g, std::stoi(argv[2]), argv[1]);
+    solveCopsAndRobbers(&g, std::stoi(argv[2]), argv[1], cacheDir);
     return 0;
 }
\ No newline at end of file
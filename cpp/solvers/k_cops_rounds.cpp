@@ -14,8 +14,10 @@
  * blocks of memory, maximizing CPU cache locality and eliminating heap fragmentation.
  * - Precomputed CSR Transitions: Avoids the catastrophic slowdown of calculating 
  * Cartesian products on the fly. All possible team moves are calculated exactly 
- * once upfront and packed into a flat 1D array, allowing instant adjacency 
- * lookups during the synchronous induction loop.
+ * once upfront and packed into delta + varint encoded CSR rows, which are 
+ * decoded once per configuration during the synchronous induction loop. The 
+ * table is kept on disk with `--transition-cache [dir]` and memory mapped on 
+ * later runs.
  * - Minimax Path Extraction: By tracking `stepsToWin`, the algorithm evaluates 
  * not just *if* the cops win, but *how fast*. During extraction, it walks the 
  * DP table, with cops choosing moves that minimize the robber's survival time, 
@@ -23,6 +25,9 @@
  * - Python Bridging: Offloads the heavy lifting of JSON formatting and Numpy 
  * binary (.npz) compression to `export_helper.py` via system calls. This keeps 
  * the C++ engine incredibly lean and focused strictly on raw graph mathematics.
+ * - Vertex Relabelling (`--relabel bfs|rcm`): Solves under a low-bandwidth 
+ * node order (`VertexOrdering`), then writes the start, the path and the DP 
+ * dump back in the file's labels, so the Python side sees no difference.
  * * PERFORMANCE METRICS (on scotlandyard-yellow with 3 cops)
  * - Memory -> Not Tracked Yet
  * - Time -> 6 seconds
@@ -32,7 +37,9 @@
 #include "Graph.h"
 #include "AdjacencyList.h"
 #include "copconfig.h"
+#include "TransitionCache.h"
 #include "Allocator.h"
+#include "VertexOrdering.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -41,104 +48,45 @@
 #include <fstream>
 #include <iomanip>
 #include <cstdlib>
-
-// --- STEP 2: Build CSR Transitions (Raw Array Outputs) ---
-void buildTransitions(size_t configCount, int k, int N, const uint8_t* configs, const AdjacencyList& adj,
-                      size_t*& outTransitionHeads, size_t*& outTransitions, size_t& totalTransCount) {
-    
-    outTransitionHeads = new size_t[configCount + 1];
-    outTransitionHeads[0] = 0;
-    
-    std::vector<size_t> tempAllTransitions; // Temporary for building
-    tempAllTransitions.reserve(configCount * 8); 
-
-    std::vector<size_t> tempMoves;
-    tempMoves.reserve(1024); 
-
-    uint8_t options[MAX_COPS][256];
-    int optionCount[MAX_COPS];
-    int odometer[MAX_COPS];
-    uint8_t moveConfig[MAX_COPS];
-
-    for (size_t cId = 0; cId < configCount; cId++) {
-        tempMoves.clear(); 
-        const uint8_t* currentCops = &configs[cId * k];
-        
-        for (int i = 0; i < k; i++) {
-            uint8_t u = currentCops[i];
-            options[i][0] = u; 
-            int count = 1;
-            uint8_t* edges = adj.getEdges(u);
-            int eIdx = 0;
-            while (edges[eIdx] != 255) options[i][count++] = edges[eIdx++];
-            optionCount[i] = count;
-        }
-
-        memset(odometer, 0, MAX_COPS * sizeof(int));
-        
-        while (true) {
-            for (int i = 0; i < k; ++i) moveConfig[i] = options[i][odometer[i]];
-            std::sort(moveConfig, moveConfig + k);
-            
-            size_t nextId = static_cast<size_t>(-1); 
-            size_t left = 0, right = configCount - 1;
-            while (left <= right) {
-                size_t mid = left + (right - left) / 2;
-                int cmp = std::memcmp(&configs[mid * k], moveConfig, k);
-                if (cmp == 0) { nextId = mid; break; }
-                if (cmp < 0) left = mid + 1;
-                else right = mid - 1;
-            }
-            
-            tempMoves.push_back(nextId * N);
-            
-            int p = k - 1;
-            while (p >= 0) {
-                odometer[p]++;
-                if (odometer[p] < optionCount[p]) break;
-                odometer[p] = 0; p--;
-            }
-            if (p < 0) break;
-        }
-
-        std::sort(tempMoves.begin(), tempMoves.end());
-        tempMoves.erase(std::unique(tempMoves.begin(), tempMoves.end()), tempMoves.end());
-        
-        tempAllTransitions.insert(tempAllTransitions.end(), tempMoves.begin(), tempMoves.end());
-        outTransitionHeads[cId + 1] = tempAllTransitions.size();
-    }
-
-    totalTransCount = tempAllTransitions.size();
-    outTransitions = new size_t[totalTransCount];
-    std::memcpy(outTransitions, tempAllTransitions.data(), totalTransCount * sizeof(size_t));
-}
+#include <string>
 
 // --- MAIN ENGINE ---
-void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
+void solveCopsAndRobbers(Graph* g, const VertexOrdering& ordering, int k, const char* filename, const char* cacheDir) {
     int N = g->nodeCount;
     if (N == 0) return;
 
     AdjacencyList adj(g);
 
-    size_t configCount;
-    uint8_t* configs = generateCopConfigs(k, N, &configCount);
-    if (!configs) return;
-
-    double configsMB = static_cast<double>(configCount * k * sizeof(uint8_t)) / (1024.0 * 1024.0);
-    std::cout << "\n[Memory] configs array: " << std::fixed << std::setprecision(2) << configsMB << " MB\n";
+    if (k <= 0 || k > static_cast<int>(MAX_COPS)) {
+        std::cerr << "FATAL: Number of cops (k) exceeds maximum supported limit of " << MAX_COPS << ".\n";
+        return;
+    }
 
-    size_t* transitionHeads = nullptr;
-    size_t* transitions = nullptr;
-    size_t totalTransCount = 0;
-    buildTransitions(configCount, k, N, configs, adj, transitionHeads, transitions, totalTransCount);
+    CopConfigRanker ranker(k, N);
+    size_t configCount = ranker.configCount;
+    if (configCount == 0) return;
 
-    double transitionsMB = static_cast<double>((configCount + 1 + totalTransCount) * sizeof(size_t)) / (1024.0 * 1024.0);
-    std::cout << "[Memory] transitions CSR: " << std::fixed << std::setprecision(2) << transitionsMB << " MB\n";
+    // Configs + CSR transitions, mapped from disk when an earlier run left them behind
+    Allocator mem;
+    TransitionCache table;
+    std::string cacheFile = TransitionCache::getDefaultPath(cacheDir, std::string(filename) + ordering.getCacheSuffix(), k);
+    if (!table.constructFrom(&adj, &ranker, cacheFile.c_str(), &mem)) return;
+    if (table.loadedFromDisk) mem.trackExternal("Transition Cache (Mapped)", table.getMappedBytes());
+    const uint8_t* configs = table.configs;
+    const CompressedTransitions& transitions = table.transitions;
+
+    double tableMB = static_cast<double>(table.getMemoryFootprint()) / (1024.0 * 1024.0);
+    double mappedMB = static_cast<double>(table.getMappedBytes()) / (1024.0 * 1024.0);
+    double uncompressedMB = static_cast<double>(transitions.getUncompressedFootprint()) / (1024.0 * 1024.0);
+    std::cout << "\n[Memory] configs + transitions CSR (heap): " << std::fixed << std::setprecision(2) << tableMB << " MB ("
+              << mappedMB << " MB mapped, " << uncompressedMB << " MB uncompressed)\n";
+
+    // Scratch row for the decoded team moves of one configuration
+    std::vector<size_t> copTrans(transitions.maxRowLength);
 
     size_t numStates = configCount * N;
 
     // Allocate Flat Arrays using Arena Allocator
-    Allocator mem;
     uint8_t* copTurnWins = nullptr;
     uint8_t* robberTurnWins = nullptr;
     int* stepsToWin = nullptr;
@@ -156,8 +104,8 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
     mem.allocate();
     mem.print(); // Display the perfectly aligned, pooled allocation footprint
 
-    // Overwrite the Allocator's 0-fill for the tracking variables
-    std::fill_n(stepsToWin, numStates, -1);
+    // Overwrite the Allocator's 0-fill for the tracking variables (a parallel first-touch fill)
+    Allocator::fill(stepsToWin, numStates, -1);
 
     // --- INITIALIZATION ---
     int initialWins = 0;
@@ -190,8 +138,7 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
         size_t robberWinsCount = 0;
 
         for (size_t cId = 0; cId < configCount; ++cId) {
-            size_t copTransStart = transitionHeads[cId];
-            size_t copTransEnd = transitionHeads[cId + 1];
+            size_t copTransCount = transitions.decodeRow(cId, copTrans.data(), N);
             size_t baseStateId = cId * N;
             uint8_t* rEdges = adj.getEdges(0); 
 
@@ -199,7 +146,7 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
                 size_t stateId = baseStateId + r;
 
                 if (copTurnWins[stateId] && robberTurnWins[stateId]) {
-                    rEdges += adj.maxDegree;
+                    rEdges += adj.stride;
                     continue;
                 }
 
@@ -220,15 +167,15 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
                 // LEFT SIDE: Cop's Turn
                 if (!copTurnWins[stateId]) {
                     bool canWin = false;
-                    for (size_t i = copTransStart; i < copTransEnd; ++i) {
-                        size_t nextStateId = transitions[i] + r;
+                    for (size_t i = 0; i < copTransCount; ++i) {
+                        size_t nextStateId = copTrans[i] + r;
                         if (robberTurnWins[nextStateId]) {
                             canWin = true; break; 
                         }
                     }
                     if (canWin) copWinsToApply[copWinsCount++] = stateId;
                 }
-                rEdges += adj.maxDegree;
+                rEdges += adj.stride;
             }
         }
 
@@ -273,9 +220,16 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
         }
     }
 
+    // Everything printed or exported below is in the graph file's labels
+    uint8_t originalCops[MAX_COPS];
+    auto writeConfig = [&](std::ostream& out, size_t cId, const char* separator) {
+        ordering.configToOriginal(&configs[cId * k], k, originalCops);
+        for (int i = 0; i < k; i++) out << (int)originalCops[i] << (i == k - 1 ? "" : separator);
+    };
+
     if (winningStartCId != -1) {
         std::cout << "RESULT: WIN. Best Cop Position: (";
-        for(int i = 0; i < k; i++) std::cout << (int)configs[winningStartCId * k + i] << (i == k - 1 ? "" : ", ");
+        writeConfig(std::cout, winningStartCId, ", ");
         std::cout << ")\nCapture Time: " << overallMinWorstCase << " rounds.\n";
         
         std::cout << "Extracting perfect game path...\n";
@@ -298,19 +252,18 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
             }
 
             // Cop Turn Path Write
-            for(int i = 0; i < k; i++) pathFile << (int)configs[currCId * k + i] << (i == k - 1 ? "" : ",");
-            pathFile << "|" << currRobber << (caught ? "|Game Over - Captured!\n" : "|Cop's Turn\n");
+            writeConfig(pathFile, currCId, ",");
+            pathFile << "|" << ordering.toOriginal(currRobber) << (caught ? "|Game Over - Captured!\n" : "|Cop's Turn\n");
             if (caught) break;
 
             // --- INSTANT COP MOVE CALCULATION (Using CSR Transitions) ---
             size_t bestNextCId = currCId;
             int minWorstCaseSteps = 999999;
             
-            size_t copTransStart = transitionHeads[currCId];
-            size_t copTransEnd = transitionHeads[currCId + 1];
+            size_t copTransCount = transitions.decodeRow(currCId, copTrans.data());
             
-            for (size_t i = copTransStart; i < copTransEnd; ++i) {
-                size_t nextCId = transitions[i] / N; // Undo the * N optimization from building
+            for (size_t i = 0; i < copTransCount; ++i) {
+                size_t nextCId = copTrans[i];
                 
                 int worstCaseRobberResponse = -1;
                 bool isValidCopMove = true;
@@ -346,14 +299,14 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
                 if (configs[currCId * k + i] == currRobber) caught = true;
             }
             if (caught) {
-                for(int i = 0; i < k; i++) pathFile << (int)configs[currCId * k + i] << (i == k - 1 ? "" : ",");
-                pathFile << "|" << currRobber << "|Game Over - Captured!\n";
+                writeConfig(pathFile, currCId, ",");
+                pathFile << "|" << ordering.toOriginal(currRobber) << "|Game Over - Captured!\n";
                 break;
             }
 
             // Robber Turn Path Write
-            for(int i = 0; i < k; i++) pathFile << (int)configs[currCId * k + i] << (i == k - 1 ? "" : ",");
-            pathFile << "|" << currRobber << "|Robber's Turn\n";
+            writeConfig(pathFile, currCId, ",");
+            pathFile << "|" << ordering.toOriginal(currRobber) << "|Robber's Turn\n";
 
             // Find best next robber move
             int bestNextRobber = currRobber;
@@ -375,8 +328,8 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
         for (size_t cId = 0; cId < configCount; ++cId) {
             for (int r = 0; r < N; ++r) {
                 size_t sId = cId * N + r;
-                for(int i = 0; i < k; i++) dpFile << (int)configs[cId * k + i] << (i == k - 1 ? "" : ",");
-                dpFile << "|" << r << "|" << stepsToWin[sId] << "\n";
+                writeConfig(dpFile, cId, ",");
+                dpFile << "|" << ordering.toOriginal(r) << "|" << stepsToWin[sId] << "\n";
             }
         }
         dpFile.close();
@@ -389,23 +342,47 @@ void solveCopsAndRobbers(Graph* g, int k, const char* filename) {
         std::cout << "RESULT: LOSS. Robber can evade forever.\n";
     }
 
-    // Cleanup Raw Arrays
-    delete[] configs;
-    delete[] transitionHeads;
-    delete[] transitions;
+    // Cleanup: TransitionCache releases the configs and transitions
     // Allocator handles all 5 DP/buffer arrays!
 }
 
 // --- ENTRY POINT ---
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops>\n";
+    VertexOrdering::Method relabel = VertexOrdering::Method::ORIGINAL;
+    const char* cacheDir = nullptr;
+    bool badArgs = (argc < 3);
+
+    for (int i = 3; i < argc && !badArgs; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--relabel" && i + 1 < argc && VertexOrdering::parseMethod(argv[i + 1], &relabel)) {
+            i++;
+        } else if (arg == "--transition-cache") {
+            cacheDir = (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) ? argv[++i] : "transition_cache";
+        } else {
+            badArgs = true;
+        }
+    }
+
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <graph_file.txt> <num_cops> [--relabel m] [--transition-cache [d]]\n";
+        std::cout << "  --relabel m     solve under a cache-friendlier node order: bfs or rcm (default: original)\n";
+        std::cout << "  --transition-cache [d] keep the transition table in directory d for later runs (default: transition_cache)\n";
         return 1;
     }
     const char* filename = argv[1];
     int k = std::stoi(argv[2]);
 
     Graph g(filename);
-    solveCopsAndRobbers(&g, k, filename);
+
+    // Solve on the relabelled graph, the path and DP exports are mapped back to the file's labels
+    VertexOrdering ordering;
+    ordering.constructFrom(&g, relabel);
+    ordering.apply(&g);
+    if (relabel != VertexOrdering::Method::ORIGINAL) {
+        std::cout << "Vertex order: " << ordering.getMethodName() << " (bandwidth " << ordering.bandwidthBefore
+                  << " -> " << ordering.bandwidthAfter << ")\n";
+    }
+
+    solveCopsAndRobbers(&g, ordering, k, filename, cacheDir);
     return 0;
 }
\ No newline at end of file
@@ -187,7 +187,7 @@ private:
     }
 
 public:
-    CopsAndRobbersSolver(GraphLimited* graph, int numCops, int numTickets) 
+    CopsAndRobbersSolver(GraphLimited* graph, int numCops, int numTickets, const std::string& outOfCoreDir = "") 
         : g(graph), k(numCops), n(numTickets) {
         
         T = n + 1;
@@ -204,11 +204,13 @@ public:
         double memGB = static_cast<double>(totalStates) / (1024.0 * 1024.0 * 1024.0);
         std::cout << "Required States: " << totalStates << " (" << std::fixed << std::setprecision(2) << memGB << " GB)\n";
         
-        if (memGB > 10.0) {
+        // Past 10 GB the table has to go to disk (a sparse temporary file the kernel pages in and out)
+        if (memGB > 10.0 && outOfCoreDir.empty()) {
             std::cerr << "FATAL ERROR: Memory requirement exceeds 10 GB limit for prototype safety.\n";
-            std::cerr << "Try a smaller graph or fewer tickets.\n";
+            std::cerr << "Try a smaller graph or fewer tickets, or pass --out-of-core <dir> to keep the table on disk.\n";
             exit(1);
         }
+        if (!outOfCoreDir.empty()) mem.setBackingDirectory(outOfCoreDir);
 
         // Drop in the Allocator for the monolithic array
         mem.requestAlloc("Mixed-Radix DP Table", totalStates, &dpTable);
@@ -332,9 +334,11 @@ public:
 // --- ENTRY POINT ---
 int main(int argc, char* argv[]) {
 
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <num_tickets>\n";
+    bool badArgs = (argc != 2 && !(argc == 4 && std::string(argv[2]) == "--out-of-core"));
+    if (badArgs) {
+        std::cout << "Usage: " << argv[0] << " <num_tickets> [--out-of-core dir]\n";
         std::cout << "Example: " << argv[0] << " 5\n";
+        std::cout << "  --out-of-core d keep the DP table in a temporary file in directory d, lifting the 10 GB limit\n";
         return 1;
     }
 
@@ -343,7 +347,8 @@ int main(int argc, char* argv[]) {
 
     GraphLimited g;
     
-    CopsAndRobbersSolver solver(&g, k, n);
+    std::string outOfCoreDir = (argc == 4) ? argv[3] : "";
+    CopsAndRobbersSolver solver(&g, k, n, outOfCoreDir);
     solver.solve();
 
     return 0;